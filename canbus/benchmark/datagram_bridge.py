@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2025 by T3 Foundation. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#     https://docs.t3gemstone.org/en/license
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Runs canbus-gateway in bridge mode over UDP loopback, decoded by canbus-converter, while the canbus-sender
+# generator loads a virtual CAN interface. Prints for each datagram size the bridged frame rate, the datagram fill
+# ratio, how many datagrams went out at the flush timeout and how many were lost. Create the interface with
+# `task create-virtual-can` and build with `task build` first.
+
+import argparse
+import os
+import re
+import signal
+import subprocess
+import sys
+import time
+
+BUILD_DIR = os.path.join(os.environ.get("PROJDIR", "."), "build/examples/canbus/cpp")
+GATEWAY = os.path.join(BUILD_DIR, "canbus-gateway/canbus-gateway")
+CONVERTER = os.path.join(BUILD_DIR, "canbus-converter/canbus-converter")
+SENDER = os.path.join(BUILD_DIR, "canbus-sender/canbus-sender")
+
+DATAGRAM_PATTERN = re.compile(
+    r"Sent (\d+) datagram\(s\) of up to \d+ bytes, ([\d.e+-]+) frames per datagram, "
+    r"fill ratio ([\d.e+-]+)%, (\d+) sent at the flush timeout"
+)
+DECODED_PATTERN = re.compile(
+    r"Decoded (\d+) frame\(s\) from (\d+) datagram\(s\) in ([\d.e+-]+) s .*lost (\d+), invalid (\d+)"
+)
+LATENCY_PATTERN = re.compile(r"Forwarding latency: p50=(\S+) p90=\S+ p99=(\S+)")
+
+
+def run_bridge(interface: str, port: int, size: int, timeout_ms: str, rate: str, duration: float) -> dict:
+    converter = subprocess.Popen(
+        [CONVERTER, "-u", str(port), "-o", os.devnull],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.STDOUT,
+        text=True,
+    )
+    gateway = subprocess.Popen(
+        [GATEWAY, "-u", f"127.0.0.1:{port}", "-s", str(size), "-t", timeout_ms, interface],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.STDOUT,
+        text=True,
+    )
+    time.sleep(0.5)
+
+    sender = subprocess.Popen(
+        [SENDER, "-g", rate, interface],
+        stdout=subprocess.DEVNULL,
+        stderr=subprocess.DEVNULL,
+    )
+    time.sleep(duration)
+    sender.send_signal(signal.SIGINT)
+    sender.wait()
+
+    # Let the last datagram reach the flush timeout before stopping the bridge, then the decoder
+    time.sleep(0.5)
+    gateway.send_signal(signal.SIGINT)
+    gateway_output, _ = gateway.communicate()
+    time.sleep(0.2)
+    converter.send_signal(signal.SIGINT)
+    converter_output, _ = converter.communicate()
+
+    result = {
+        "datagrams": 0,
+        "frames_per_datagram": 0.0,
+        "fill": 0.0,
+        "timeouts": 0,
+        "decoded": 0,
+        "seconds": duration,
+        "lost": 0,
+        "invalid": 0,
+        "p50": "-",
+        "p99": "-",
+    }
+
+    match = DATAGRAM_PATTERN.search(gateway_output)
+    if match:
+        result["datagrams"] = int(match.group(1))
+        result["frames_per_datagram"] = float(match.group(2))
+        result["fill"] = float(match.group(3))
+        result["timeouts"] = int(match.group(4))
+
+    match = LATENCY_PATTERN.search(gateway_output)
+    if match:
+        result["p50"] = match.group(1)
+        result["p99"] = match.group(2)
+
+    match = DECODED_PATTERN.search(converter_output)
+    if match:
+        result["decoded"] = int(match.group(1))
+        result["seconds"] = float(match.group(3)) or duration
+        result["lost"] = int(match.group(4))
+        result["invalid"] = int(match.group(5))
+
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure the canbus-gateway datagram bridge over UDP loopback")
+    parser.add_argument("interface", nargs="?", default="vcan0", help="virtual CAN interface (default: vcan0)")
+    parser.add_argument("-g", "--rate", default="max", help="generator rate in frames/s, or 'max' (default: max)")
+    parser.add_argument("-d", "--duration", type=float, default=5.0, help="seconds per datagram size (default: 5)")
+    parser.add_argument("-p", "--port", type=int, default=5000, help="UDP loopback port (default: 5000)")
+    parser.add_argument("-t", "--timeout", default="10", help="flush timeout in ms (default: 10)")
+    parser.add_argument(
+        "-s", "--sizes", default="256,1472,8192", help="comma separated datagram sizes (default: 256,1472,8192)"
+    )
+    args = parser.parse_args()
+
+    for program in (GATEWAY, CONVERTER, SENDER):
+        if not os.access(program, os.X_OK):
+            print(f"{program} not found, build the C++ examples first", file=sys.stderr)
+            return 1
+
+    print(
+        f"{'size':>6} {'decoded':>10} {'frames/s':>10} {'frames/dgram':>13} {'fill':>7} {'timeouts':>9} "
+        f"{'lost':>6} {'p50':>8} {'p99':>8}"
+    )
+
+    for size in (int(size) for size in args.sizes.split(",")):
+        result = run_bridge(args.interface, args.port, size, args.timeout, args.rate, args.duration)
+        print(
+            f"{size:>6} {result['decoded']:>10} {result['decoded'] / result['seconds']:>10.0f} "
+            f"{result['frames_per_datagram']:>13.1f} {result['fill']:>6.1f}% {result['timeouts']:>9} "
+            f"{result['lost'] + result['invalid']:>6} {result['p50']:>8} {result['p99']:>8}"
+        )
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
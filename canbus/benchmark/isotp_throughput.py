@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2025 by T3 Foundation. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#     https://docs.t3gemstone.org/en/license
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Measures ISO-TP throughput between the C++ canbus-sender and canbus-receiver on a virtual CAN interface, for
+# message sizes from 64 bytes up to the 4095 byte ISO-TP limit. The sender sends back to back, so the rate is set
+# by flow control: block size and STmin from the receiver. Needs the can-isotp module (`sudo modprobe can-isotp`).
+
+import argparse
+import os
+import re
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+BUILD_DIR = os.path.join(os.environ.get("PROJDIR", "."), "build/examples/canbus/cpp")
+RECEIVER = os.path.join(BUILD_DIR, "canbus-receiver/canbus-receiver")
+SENDER = os.path.join(BUILD_DIR, "canbus-sender/canbus-sender")
+
+MESSAGE_SIZES = [64, 128, 256, 512, 1024, 2048, 4095]
+
+THROUGHPUT_PATTERN = re.compile(r"Received (\d+) ISO-TP payload byte\(s\) in ([\d.e+-]+) s(?:, ([\d.e+-]+) KB/s)?")
+MESSAGE_PATTERN = re.compile(r"Received (\d+) frame\(s\)")
+
+
+def run_size(interface: str, size: int, args) -> tuple:
+    receiver_options = ["-i", "7E8:7E0", "-k", str(args.block_size), "-m", str(args.stmin)]
+    sender_options = ["-i", "7E0:7E8", "-l", str(size), "-g", "max"]
+    if args.padding is not None:
+        receiver_options += ["-x", args.padding]
+        sender_options += ["-x", args.padding]
+    if args.fd:
+        receiver_options.append("-f")
+        sender_options.append("-f")
+
+    # Message printing goes to a file, reading it through a pipe would slow the receiver down
+    with tempfile.TemporaryFile(mode="w+") as output:
+        receiver = subprocess.Popen([RECEIVER, *receiver_options, interface], stdout=output, stderr=subprocess.STDOUT)
+        time.sleep(0.5)
+
+        sender = subprocess.Popen(
+            [SENDER, *sender_options, interface], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL
+        )
+        time.sleep(args.duration)
+
+        # The sender finishes with an END message, which stops the receiver
+        sender.send_signal(signal.SIGINT)
+        sender.wait()
+        try:
+            receiver.wait(timeout=5)
+        except subprocess.TimeoutExpired:
+            receiver.send_signal(signal.SIGINT)
+            receiver.wait()
+
+        output.seek(0)
+        text = output.read()
+
+    messages = 0
+    kb_per_second = 0.0
+
+    match = MESSAGE_PATTERN.search(text)
+    if match:
+        messages = int(match.group(1))
+
+    match = THROUGHPUT_PATTERN.search(text)
+    if match and match.group(3):
+        kb_per_second = float(match.group(3))
+
+    return messages, kb_per_second
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure ISO-TP throughput on a vcan interface")
+    parser.add_argument("interface", nargs="?", default="vcan0", help="virtual CAN interface (default: vcan0)")
+    parser.add_argument("-d", "--duration", type=float, default=3.0, help="seconds per message size (default: 3)")
+    parser.add_argument("-k", "--block-size", type=int, default=0, help="receiver block size (default: 0)")
+    parser.add_argument("-m", "--stmin", type=int, default=0, help="receiver STmin in microseconds (default: 0)")
+    parser.add_argument("-x", "--padding", help="pad frames with this hex byte")
+    parser.add_argument("-f", "--fd", action="store_true", help="use CAN FD frames (interface MTU 72)")
+    args = parser.parse_args()
+
+    for program in (RECEIVER, SENDER):
+        if not os.access(program, os.X_OK):
+            print(f"{program} not found, build the C++ examples first", file=sys.stderr)
+            return 1
+
+    print(f"{'size (B)':>9} {'messages':>10} {'KB/s':>10}")
+
+    for size in MESSAGE_SIZES:
+        messages, kb_per_second = run_size(args.interface, size, args)
+        print(f"{size:>9} {messages:>10} {kb_per_second:>10.1f}")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2025 by T3 Foundation. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#     https://docs.t3gemstone.org/en/license
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Compares the receive backends of the C++ canbus-receiver on a virtual CAN interface. Each backend receives the
+# same generator load while capturing to a file in /dev/shm, so the numbers show the cost of getting frames into
+# userspace rather than of printing them. With --transmit the generator's sendmmsg() and io_uring backends are
+# compared instead, received by the recvmmsg backend. Create the interface with `task create-virtual-can` and
+# build with `task build` first.
+
+import argparse
+import os
+import re
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+BUILD_DIR = os.path.join(os.environ.get("PROJDIR", "."), "build/examples/canbus/cpp")
+RECEIVER = os.path.join(BUILD_DIR, "canbus-receiver/canbus-receiver")
+SENDER = os.path.join(BUILD_DIR, "canbus-sender/canbus-sender")
+
+# Backend name and the receiver options selecting it, all process frames inline on the reader thread. The receiver
+# has no plain read() loop, recvmmsg() with a batch of one stands in for it as the one syscall per frame baseline.
+BACKENDS = [
+    ("recvmmsg-b1", ["-b", "1", "-r", "0"]),
+    ("recvmmsg", ["-b", "32", "-r", "0"]),
+    ("packet-mmap", ["-P", "-r", "0"]),
+    ("io_uring", ["-U", "-b", "32", "-r", "0"]),
+]
+
+# Generator backend name and the sender options selecting it
+SENDER_BACKENDS = [
+    ("sendmmsg", []),
+    ("io_uring", ["-U"]),
+]
+
+RECEIVED_PATTERN = re.compile(r"Received (\d+) frame\(s\) in (\d+) syscall\(s\)")
+CPU_PATTERN = re.compile(r"CPU time ([\d.e+-]+) s(?:, ([\d.e+-]+) ns per frame)?")
+DROP_PATTERN = re.compile(r"(?:Packet rings|Receive queues) dropped (\d+)")
+GENERATED_PATTERN = re.compile(r"Generated (\d+) frame\(s\) in ([\d.e+-]+) s .*dropped (\d+), backpressure waits (\d+)")
+
+
+def run_backend(interface: str, options: list, rate: str, duration: float, sender_options: list = None) -> dict:
+    with tempfile.TemporaryDirectory(dir="/dev/shm") as directory:
+        capture = os.path.join(directory, "benchmark.cap")
+        receiver = subprocess.Popen(
+            [RECEIVER, *options, "-w", capture, "-c", "4000000", interface],
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True,
+        )
+        time.sleep(0.5)
+
+        sender = subprocess.Popen(
+            [SENDER, "-g", rate, *(sender_options or []), interface],
+            stdout=subprocess.PIPE,
+            stderr=subprocess.DEVNULL,
+            text=True,
+        )
+        time.sleep(duration)
+
+        # The sender finishes with the END frame, which stops the receiver
+        sender.send_signal(signal.SIGINT)
+        sender_output, _ = sender.communicate()
+        try:
+            output, _ = receiver.communicate(timeout=5)
+        except subprocess.TimeoutExpired:
+            receiver.send_signal(signal.SIGINT)
+            output, _ = receiver.communicate()
+
+    result = {
+        "frames": 0,
+        "wakeups": 0,
+        "cpu_seconds": 0.0,
+        "ns_per_frame": 0.0,
+        "drops": 0,
+        "sent": 0,
+        "send_seconds": duration,
+        "backpressure_waits": 0,
+    }
+
+    match = GENERATED_PATTERN.search(sender_output)
+    if match:
+        result["sent"] = int(match.group(1))
+        result["send_seconds"] = float(match.group(2))
+        result["backpressure_waits"] = int(match.group(4))
+
+    match = RECEIVED_PATTERN.search(output)
+    if match:
+        result["frames"] = int(match.group(1))
+        result["wakeups"] = int(match.group(2))
+
+    match = CPU_PATTERN.search(output)
+    if match:
+        result["cpu_seconds"] = float(match.group(1))
+        result["ns_per_frame"] = float(match.group(2) or 0)
+
+    match = DROP_PATTERN.search(output)
+    if match:
+        result["drops"] = int(match.group(1))
+
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare canbus-receiver backends on a vcan interface")
+    parser.add_argument("interface", nargs="?", default="vcan0", help="virtual CAN interface (default: vcan0)")
+    parser.add_argument("-g", "--rate", default="max", help="generator rate in frames/s, or 'max' (default: max)")
+    parser.add_argument("-d", "--duration", type=float, default=5.0, help="seconds per backend (default: 5)")
+    parser.add_argument("-t", "--transmit", action="store_true", help="compare the generator backends instead")
+    args = parser.parse_args()
+
+    for program in (RECEIVER, SENDER):
+        if not os.access(program, os.X_OK):
+            print(f"{program} not found, build the C++ examples first", file=sys.stderr)
+            return 1
+
+    if args.transmit:
+        print(f"{'backend':<12} {'sent':>10} {'sent/s':>10} {'received':>10} {'backpressure':>13}")
+
+        for name, sender_options in SENDER_BACKENDS:
+            result = run_backend(args.interface, ["-b", "32", "-r", "0"], args.rate, args.duration, sender_options)
+            rate = result["sent"] / result["send_seconds"] if result["send_seconds"] > 0 else 0.0
+            print(
+                f"{name:<12} {result['sent']:>10} {rate:>10.0f} {result['frames']:>10} "
+                f"{result['backpressure_waits']:>13}"
+            )
+
+        return 0
+
+    print("recvmmsg-b1 receives one frame per syscall, the baseline the batched backends are compared against")
+    print(f"{'backend':<12} {'frames':>10} {'frames/s':>10} {'CPU ns/frame':>13} {'frames/wakeup':>14} {'drops':>8}")
+
+    for name, options in BACKENDS:
+        result = run_backend(args.interface, options, args.rate, args.duration)
+        per_wakeup = result["frames"] / result["wakeups"] if result["wakeups"] else 0.0
+        print(
+            f"{name:<12} {result['frames']:>10} {result['frames'] / args.duration:>10.0f} "
+            f"{result['ns_per_frame']:>13.0f} {per_wakeup:>14.1f} {result['drops']:>8}"
+        )
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
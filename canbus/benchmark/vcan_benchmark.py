@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2025 by T3 Foundation. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#     https://docs.t3gemstone.org/en/license
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Compares the C, C++ and Python canbus-receiver implementations on a virtual CAN interface at rising load. The
+# C++ canbus-sender generator drives every run, since it is the only sender that can hold a given rate. Each
+# receiver prints its frames to a file in /dev/shm, so the numbers include formatting the output, which is what
+# the three implementations have in common.
+#
+# Per run the report has the frames sent and received, the receive rate, the frames lost between sender and
+# receiver, the receiver's CPU usage and, for receivers that print kernel timestamps, the one-way latency from
+# the sender queuing a frame to the kernel timestamping it on the receive socket. The sender puts its
+# CLOCK_REALTIME send time into the payload (--pattern timestamp) for that.
+#
+# Build with `task build` first. The interface is created when missing, which needs root, otherwise create it
+# with `task create-virtual-can`. `task canbus-benchmark -- ARGS` runs this script with ARGS.
+
+import argparse
+import json
+import os
+import platform
+import re
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+PROJDIR = os.environ.get("PROJDIR", ".")
+BUILD_DIR = os.path.join(PROJDIR, "build/examples/canbus")
+SENDER = os.path.join(BUILD_DIR, "cpp/canbus-sender/canbus-sender")
+
+# Implementation name and the command line running its receiver, the interface is appended
+RECEIVERS = [
+    ("c", [os.path.join(BUILD_DIR, "c/canbus-receiver/canbus-receiver")]),
+    ("cpp", [os.path.join(BUILD_DIR, "cpp/canbus-receiver/canbus-receiver"), "-b", "32", "-r", "0"]),
+    ("python", [sys.executable, os.path.join(BUILD_DIR, "python/canbus-receiver/canbus-receiver")]),
+]
+
+FRAME_ID = 0x123
+
+FRAME_PATTERN = re.compile(r"^(?:\((\d+)\.(\d{6})\) )?(?:\S+ )?Received: ID=0x123, DLC=\d+, Data=([0-9A-F ]*)\(")
+GENERATED_PATTERN = re.compile(r"Generated (\d+) frame\(s\) in ([\d.e+-]+) s .*dropped (\d+)")
+
+
+def ensure_interface(interface: str) -> bool:
+    if os.path.exists(f"/sys/class/net/{interface}"):
+        return True
+
+    commands = [
+        ["ip", "link", "add", "dev", interface, "type", "vcan"],
+        ["ip", "link", "set", interface, "up"],
+    ]
+    for command in commands:
+        if subprocess.run(command, stderr=subprocess.DEVNULL).returncode != 0:
+            print(f"Could not create {interface}, run `task create-virtual-can` as a user with sudo", file=sys.stderr)
+            return False
+
+    return True
+
+
+def parse_output(path: str) -> tuple:
+    """Counts received frames and collects latencies in microseconds from a receiver's output"""
+    received = 0
+    latencies = []
+
+    with open(path, errors="replace") as output:
+        for line in output:
+            match = FRAME_PATTERN.match(line)
+            if not match:
+                continue
+
+            received += 1
+            if match.group(1) is None:
+                continue
+
+            data = bytes.fromhex(match.group(3))
+            if len(data) < 8:
+                continue
+
+            kernel_us = int(match.group(1)) * 1_000_000 + int(match.group(2))
+            sent_us = int.from_bytes(data[:8], "little") / 1000
+            latencies.append(kernel_us - sent_us)
+
+    return received, latencies
+
+
+def percentiles(values: list) -> dict:
+    if not values:
+        return None
+
+    values.sort()
+
+    def at(fraction: float) -> float:
+        return round(values[min(len(values) - 1, int(fraction * len(values)))], 1)
+
+    return {"p50": at(0.50), "p90": at(0.90), "p99": at(0.99), "p999": at(0.999), "max": round(values[-1], 1)}
+
+
+def run(name: str, command: list, interface: str, rate: str, duration: float) -> dict:
+    with tempfile.TemporaryDirectory(dir="/dev/shm") as directory:
+        output_path = os.path.join(directory, f"{name}.txt")
+
+        with open(output_path, "w") as output:
+            receiver = subprocess.Popen([*command, interface], stdout=output, stderr=subprocess.STDOUT)
+            time.sleep(1.0)
+
+            sender = subprocess.Popen(
+                [SENDER, "-g", rate, "-I", f"{FRAME_ID:X}", "-p", "timestamp", interface],
+                stdout=subprocess.PIPE,
+                stderr=subprocess.DEVNULL,
+                text=True,
+            )
+            time.sleep(duration)
+
+            # The sender finishes with the END frame, which stops every receiver unless it was dropped
+            sender.send_signal(signal.SIGINT)
+            sender_output, _ = sender.communicate()
+
+            # Reap the receiver with wait4() rather than Popen.wait() to get its resource usage
+            deadline = time.monotonic() + 10
+            while True:
+                pid, _, usage = os.wait4(receiver.pid, os.WNOHANG)
+                if pid != 0:
+                    break
+                if time.monotonic() > deadline:
+                    receiver.send_signal(signal.SIGINT)
+                    _, _, usage = os.wait4(receiver.pid, 0)
+                    break
+                time.sleep(0.1)
+            receiver.returncode = 0
+
+        received, latencies = parse_output(output_path)
+
+    result = {"implementation": name, "rate": rate, "sent": 0, "sender_drops": 0, "received": received}
+
+    match = GENERATED_PATTERN.search(sender_output)
+    if match:
+        result["sent"] = int(match.group(1))
+        result["sender_drops"] = int(match.group(3))
+        seconds = float(match.group(2))
+    else:
+        seconds = duration
+
+    cpu_seconds = usage.ru_utime + usage.ru_stime
+    result["frames_per_second"] = round(received / seconds, 1) if seconds > 0 else 0.0
+    result["drops"] = max(0, result["sent"] - received)
+    result["cpu_seconds"] = round(cpu_seconds, 3)
+    result["cpu_percent"] = round(100 * cpu_seconds / seconds, 1) if seconds > 0 else 0.0
+    result["latency_us"] = percentiles(latencies)
+
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare the C, C++ and Python CAN receivers on a vcan interface")
+    parser.add_argument("interface", nargs="?", default="vcan0", help="virtual CAN interface (default: vcan0)")
+    parser.add_argument(
+        "-g",
+        "--rates",
+        default="1000,10000,50000,100000,max",
+        help="comma separated generator rates in frames/s, 'max' saturates (default: 1000,10000,50000,100000,max)",
+    )
+    parser.add_argument("-d", "--duration", type=float, default=5.0, help="seconds per run (default: 5)")
+    parser.add_argument(
+        "-i",
+        "--implementations",
+        default=",".join(name for name, _ in RECEIVERS),
+        help="comma separated receivers to run (default: c,cpp,python)",
+    )
+    parser.add_argument("-o", "--output", default="vcan_benchmark.json", help="JSON report path, '-' for stdout")
+    args = parser.parse_args()
+
+    selected = args.implementations.split(",")
+    receivers = [(name, command) for name, command in RECEIVERS if name in selected]
+
+    for program in [SENDER] + [command[-1] for _, command in receivers]:
+        if not os.path.exists(program):
+            print(f"{program} not found, build the canbus examples first", file=sys.stderr)
+            return 1
+
+    if not ensure_interface(args.interface):
+        return 1
+
+    results = []
+    print(
+        f"{'impl':<7} {'rate':>7} {'sent':>9} {'received':>9} {'frames/s':>9} {'drops':>8} {'CPU %':>6} "
+        f"{'p50 us':>8} {'p99 us':>8} {'max us':>9}"
+    )
+
+    for rate in args.rates.split(","):
+        for name, command in receivers:
+            result = run(name, command, args.interface, rate, args.duration)
+            results.append(result)
+
+            latency = result["latency_us"] or {}
+            print(
+                f"{name:<7} {rate:>7} {result['sent']:>9} {result['received']:>9} "
+                f"{result['frames_per_second']:>9.0f} {result['drops']:>8} {result['cpu_percent']:>6.1f} "
+                f"{latency.get('p50', '-'):>8} {latency.get('p99', '-'):>8} {latency.get('max', '-'):>9}"
+            )
+
+    report = {
+        "interface": args.interface,
+        "duration_seconds": args.duration,
+        "kernel": platform.release(),
+        "machine": platform.machine(),
+        "results": results,
+    }
+
+    if args.output == "-":
+        json.dump(report, sys.stdout, indent=2)
+        print()
+    else:
+        with open(args.output, "w") as output:
+            json.dump(report, output, indent=2)
+        print(f"Report written to {args.output}")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,245 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "can_capture.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+CaptureWriter::CaptureWriter() {}
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+int CaptureWriter::open(const std::string& path, uint64_t capacity)
+{
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0)
+    {
+        perror("Error opening capture file");
+        return 1;
+    }
+
+    m_mapping_size = sizeof(CaptureHeader) + capacity * sizeof(CaptureRecord);
+
+    // Reserve the blocks up front so appending never faults on a full filesystem
+    int error = posix_fallocate(m_fd, 0, static_cast<off_t>(m_mapping_size));
+    if (error != 0)
+    {
+        errno = error;
+        perror("Error preallocating capture file");
+        close();
+        return 1;
+    }
+
+    m_mapping = mmap(nullptr, m_mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (m_mapping == MAP_FAILED)
+    {
+        m_mapping = nullptr;
+        perror("Error mapping capture file");
+        close();
+        return 1;
+    }
+
+    m_header = static_cast<CaptureHeader*>(m_mapping);
+    m_records = reinterpret_cast<CaptureRecord*>(static_cast<char*>(m_mapping) + sizeof(CaptureHeader));
+
+    std::memset(m_header, 0, sizeof(CaptureHeader));
+    std::memcpy(m_header->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    m_header->version = CAPTURE_VERSION;
+    m_header->header_size = sizeof(CaptureHeader);
+    m_header->record_size = sizeof(CaptureRecord);
+    m_header->capacity = capacity;
+    m_header->record_count = 0;
+
+    return 0;
+}
+
+int CaptureWriter::add_interface(int ifindex, const std::string& name)
+{
+    if (m_header->interface_count >= CAPTURE_MAX_INTERFACES)
+    {
+        std::cerr << "Capture file supports at most " << CAPTURE_MAX_INTERFACES << " interfaces" << std::endl;
+        return 1;
+    }
+
+    CaptureInterface& interface = m_header->interfaces[m_header->interface_count++];
+    interface.ifindex = static_cast<uint32_t>(ifindex);
+    std::strncpy(interface.name, name.c_str(), IFNAMSIZ - 1);
+
+    return 0;
+}
+
+void CaptureWriter::close()
+{
+    uint64_t record_count = m_header ? m_header->record_count : 0;
+
+    if (m_mapping)
+    {
+        munmap(m_mapping, m_mapping_size);
+        m_mapping = nullptr;
+        m_header = nullptr;
+        m_records = nullptr;
+    }
+
+    if (m_fd >= 0)
+    {
+        // Drop the unused preallocated tail
+        if (ftruncate(m_fd, static_cast<off_t>(sizeof(CaptureHeader) + record_count * sizeof(CaptureRecord))) < 0)
+        {
+            perror("Error truncating capture file");
+        }
+
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void CaptureWriter::prefault()
+{
+    if (m_mapping == nullptr)
+    {
+        return;
+    }
+
+    // Allocates the page cache pages and maps them writable, needs Linux 5.14
+    if (madvise(m_mapping, m_mapping_size, MADV_POPULATE_WRITE) != 0)
+    {
+        std::cout << "Warning: Could not prefault capture file (" << std::strerror(errno) << ")" << std::endl;
+    }
+}
+
+uint64_t CaptureWriter::record_count() const
+{
+    return m_header ? m_header->record_count : 0;
+}
+
+uint64_t CaptureWriter::drop_count() const
+{
+    return m_drop_count;
+}
+
+CaptureReader::CaptureReader() {}
+
+CaptureReader::~CaptureReader()
+{
+    close();
+}
+
+int CaptureReader::open(const std::string& path)
+{
+    struct stat file_stat;
+
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0)
+    {
+        perror("Error opening capture file");
+        return 1;
+    }
+
+    if (fstat(m_fd, &file_stat) < 0)
+    {
+        perror("Error reading capture file size");
+        close();
+        return 1;
+    }
+
+    m_mapping_size = static_cast<size_t>(file_stat.st_size);
+    if (m_mapping_size < sizeof(CaptureHeader))
+    {
+        std::cerr << "Capture file too short: " << path << std::endl;
+        close();
+        return 1;
+    }
+
+    m_mapping = mmap(nullptr, m_mapping_size, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (m_mapping == MAP_FAILED)
+    {
+        m_mapping = nullptr;
+        perror("Error mapping capture file");
+        close();
+        return 1;
+    }
+
+    m_header = static_cast<const CaptureHeader*>(m_mapping);
+    if (std::memcmp(m_header->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0 ||
+        m_header->version != CAPTURE_VERSION || m_header->header_size != sizeof(CaptureHeader) ||
+        m_header->record_size != sizeof(CaptureRecord))
+    {
+        std::cerr << "Not a version " << CAPTURE_VERSION << " capture file: " << path << std::endl;
+        close();
+        return 1;
+    }
+
+    // Trust the file size over the header in case the writer did not close cleanly
+    m_records = reinterpret_cast<const CaptureRecord*>(static_cast<const char*>(m_mapping) + sizeof(CaptureHeader));
+    m_record_count = std::min<uint64_t>(m_header->record_count,
+                                        (m_mapping_size - sizeof(CaptureHeader)) / sizeof(CaptureRecord));
+
+    madvise(m_mapping, m_mapping_size, MADV_SEQUENTIAL);
+
+    return 0;
+}
+
+void CaptureReader::close()
+{
+    if (m_mapping)
+    {
+        munmap(m_mapping, m_mapping_size);
+        m_mapping = nullptr;
+        m_header = nullptr;
+        m_records = nullptr;
+        m_record_count = 0;
+    }
+
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+uint64_t CaptureReader::record_count() const
+{
+    return m_record_count;
+}
+
+const CaptureRecord& CaptureReader::record(uint64_t index) const
+{
+    return m_records[index];
+}
+
+const char* CaptureReader::interface_name(uint32_t ifindex) const
+{
+    for (uint32_t i = 0; i < m_header->interface_count && i < CAPTURE_MAX_INTERFACES; i++)
+    {
+        if (m_header->interfaces[i].ifindex == ifindex)
+        {
+            return m_header->interfaces[i].name;
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,148 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CAN_CAPTURE_H
+#define CAN_CAPTURE_H
+
+#include <linux/can.h>
+#include <cstddef>
+#include <cstdint>
+#include <net/if.h>
+#include <string>
+
+// Binary capture file layout, host byte order:
+//
+//   CaptureHeader                       256 bytes
+//   CaptureRecord[capacity]             88 bytes each, the first record_count are valid
+//
+// The file is preallocated to its full capacity and written through a shared mapping, appending a frame is a
+// single fixed-size memcpy. It is truncated to the records actually written when the writer is closed.
+
+constexpr char CAPTURE_MAGIC[8] = {'T', '3', 'C', 'A', 'N', 'C', 'A', 'P'};
+constexpr uint32_t CAPTURE_VERSION = 1;
+constexpr size_t CAPTURE_MAX_INTERFACES = 8;
+
+struct CaptureInterface
+{
+    uint32_t ifindex;
+    char name[IFNAMSIZ];
+};
+
+struct CaptureHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t record_size;
+    uint32_t interface_count;
+    uint64_t capacity;
+    uint64_t record_count;
+    uint8_t reserved0[24];
+    CaptureInterface interfaces[CAPTURE_MAX_INTERFACES];
+    uint8_t reserved1[32];
+};
+
+// CaptureRecord::record_flags
+constexpr uint8_t CAPTURE_FLAG_FD = 0x01;           // CAN FD frame
+constexpr uint8_t CAPTURE_FLAG_HW_TIMESTAMP = 0x02; // Timestamp taken by the controller
+
+struct CaptureRecord
+{
+    uint64_t timestamp_ns; // CLOCK_REALTIME (or controller clock), 0 if unknown
+    uint32_t can_id;       // Including CAN_EFF_FLAG, CAN_RTR_FLAG and CAN_ERR_FLAG
+    uint32_t ifindex;
+    uint8_t len;
+    uint8_t fd_flags; // canfd_frame::flags
+    uint8_t record_flags;
+    uint8_t reserved0;
+    uint8_t data[CANFD_MAX_DLEN];
+    uint32_t reserved1;
+};
+
+static_assert(sizeof(CaptureHeader) == 256, "CaptureHeader layout changed");
+static_assert(sizeof(CaptureRecord) == 88, "CaptureRecord layout changed");
+
+class CaptureWriter
+{
+  public:
+    CaptureWriter();
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    int open(const std::string& path, uint64_t capacity);
+    int add_interface(int ifindex, const std::string& name);
+    void close();
+
+    // Faults the whole mapping in so appending never waits for the page cache
+    void prefault();
+
+    // Returns false and counts a drop when the file is full
+    bool append(const CaptureRecord& record)
+    {
+        if (m_header->record_count >= m_header->capacity)
+        {
+            m_drop_count++;
+            return false;
+        }
+
+        m_records[m_header->record_count] = record;
+        m_header->record_count++;
+        return true;
+    }
+
+    uint64_t record_count() const;
+    uint64_t drop_count() const;
+
+  private:
+    int m_fd {-1};
+    void* m_mapping {nullptr};
+    size_t m_mapping_size {0};
+    CaptureHeader* m_header {nullptr};
+    CaptureRecord* m_records {nullptr};
+    uint64_t m_drop_count {0};
+};
+
+class CaptureReader
+{
+  public:
+    CaptureReader();
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    int open(const std::string& path);
+    void close();
+
+    uint64_t record_count() const;
+    const CaptureRecord& record(uint64_t index) const;
+
+    // Interface name stored for ifindex, nullptr if the capture does not know it
+    const char* interface_name(uint32_t ifindex) const;
+
+  private:
+    int m_fd {-1};
+    void* m_mapping {nullptr};
+    size_t m_mapping_size {0};
+    const CaptureHeader* m_header {nullptr};
+    const CaptureRecord* m_records {nullptr};
+    uint64_t m_record_count {0};
+};
+
+#endif // CAN_CAPTURE_H
@@ -0,0 +1,176 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "candump_format.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// snprintf() returns the untruncated length, keep room for the flags, data and newline appended after it
+static int clamp_length(int length)
+{
+    constexpr int limit = static_cast<int>(CANDUMP_LINE_MAX - 3 - 2 * CANFD_MAX_DLEN - 1);
+    return length < 0 ? 0 : (length > limit ? limit : length);
+}
+
+size_t format_candump_line(const CaptureRecord& record, const char* interface_name, char* out)
+{
+    unsigned long long seconds = record.timestamp_ns / 1'000'000'000;
+    unsigned long long microseconds = record.timestamp_ns % 1'000'000'000 / 1000;
+    // Longer names are cut to an interface name, so the line always fits CANDUMP_LINE_MAX
+    int length = std::snprintf(out, CANDUMP_LINE_MAX, "(%010llu.%06llu) %.*s ", seconds, microseconds,
+                               static_cast<int>(IFNAMSIZ - 1), interface_name);
+    length = clamp_length(length);
+
+    // Error frames and extended IDs use 8 digits, standard IDs 3
+    if (record.can_id & CAN_ERR_FLAG)
+    {
+        length += std::snprintf(out + length, CANDUMP_LINE_MAX - length, "%08X#",
+                                record.can_id & (CAN_ERR_MASK | CAN_ERR_FLAG));
+    }
+    else if (record.can_id & CAN_EFF_FLAG)
+    {
+        length += std::snprintf(out + length, CANDUMP_LINE_MAX - length, "%08X#", record.can_id & CAN_EFF_MASK);
+    }
+    else
+    {
+        length += std::snprintf(out + length, CANDUMP_LINE_MAX - length, "%03X#", record.can_id & CAN_SFF_MASK);
+    }
+    length = clamp_length(length);
+
+    if (record.record_flags & CAPTURE_FLAG_FD)
+    {
+        out[length++] = '#';
+        out[length++] = HEX_DIGITS[record.fd_flags & 0x0F];
+    }
+    else if (record.can_id & CAN_RTR_FLAG)
+    {
+        out[length++] = 'R';
+        out[length++] = '\n';
+        return static_cast<size_t>(length);
+    }
+
+    for (unsigned int i = 0; i < record.len && i < CANFD_MAX_DLEN; i++)
+    {
+        out[length++] = HEX_DIGITS[record.data[i] >> 4];
+        out[length++] = HEX_DIGITS[record.data[i] & 0x0F];
+    }
+    out[length++] = '\n';
+
+    return static_cast<size_t>(length);
+}
+
+bool parse_candump_line(const char* line, CaptureRecord& record)
+{
+    unsigned long long seconds;
+    unsigned long microseconds;
+    char interface_name[IFNAMSIZ];
+    int offset = 0;
+
+    std::memset(&record, 0, sizeof(record));
+
+    if (std::sscanf(line, " (%llu.%lu) %15s %n", &seconds, &microseconds, interface_name, &offset) != 3 || offset == 0)
+    {
+        return false;
+    }
+    record.timestamp_ns = seconds * 1'000'000'000 + microseconds * 1000;
+
+    const char* frame = line + offset;
+    const char* separator = std::strchr(frame, '#');
+    if (separator == nullptr || separator == frame || separator - frame > 8)
+    {
+        return false;
+    }
+
+    char* id_end;
+    unsigned long can_id = std::strtoul(frame, &id_end, 16);
+    if (id_end != separator)
+    {
+        return false;
+    }
+
+    // The ID width tells standard and extended frames apart, as in candump
+    if (separator - frame == 8)
+    {
+        record.can_id = (can_id & CAN_ERR_FLAG) ? static_cast<canid_t>(can_id)
+                                                : (static_cast<canid_t>(can_id) & CAN_EFF_MASK) | CAN_EFF_FLAG;
+    }
+    else
+    {
+        record.can_id = static_cast<canid_t>(can_id) & CAN_SFF_MASK;
+    }
+
+    const char* data = separator + 1;
+    if (*data == '#')
+    {
+        int flags = hex_value(data[1]);
+        if (flags < 0)
+        {
+            return false;
+        }
+        record.record_flags |= CAPTURE_FLAG_FD;
+        record.fd_flags = static_cast<uint8_t>(flags);
+        data += 2;
+    }
+    else if (*data == 'R' || *data == 'r')
+    {
+        record.can_id |= CAN_RTR_FLAG;
+        return true;
+    }
+
+    size_t max_length = (record.record_flags & CAPTURE_FLAG_FD) ? CANFD_MAX_DLEN : CAN_MAX_DLEN;
+    while (record.len < max_length)
+    {
+        // Accept the optional '.' byte separators candump writes with -x
+        if (*data == '.')
+        {
+            data++;
+            continue;
+        }
+
+        int high = hex_value(data[0]);
+        int low = high < 0 ? -1 : hex_value(data[1]);
+        if (low < 0)
+        {
+            break;
+        }
+
+        record.data[record.len++] = static_cast<uint8_t>(high << 4 | low);
+        data += 2;
+    }
+
+    return true;
+}
@@ -0,0 +1,34 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CANDUMP_FORMAT_H
+#define CANDUMP_FORMAT_H
+
+#include "can_capture.h"
+#include <cstddef>
+
+// Longest candump log line: timestamp, interface, 8 digit ID, "##", flags and 64 data bytes
+constexpr size_t CANDUMP_LINE_MAX = 24 + IFNAMSIZ + 8 + 3 + 2 * CANFD_MAX_DLEN + 2;
+
+// Writes one candump -l style line, "(1700000000.123456) can0 123#DEADBEEF\n", and returns its length.
+// out must hold at least CANDUMP_LINE_MAX bytes.
+size_t format_candump_line(const CaptureRecord& record, const char* interface_name, char* out);
+
+// Parses one candump -l style line back into a record, ifindex is left 0. Returns false for malformed lines.
+bool parse_candump_line(const char* line, CaptureRecord& record);
+
+#endif // CANDUMP_FORMAT_H
@@ -0,0 +1,424 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dbc_database.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <endian.h>
+#include <fstream>
+#include <iostream>
+
+// Pseudo message DBC editors use to hold signals that belong to no message
+static constexpr unsigned long DBC_INDEPENDENT_SIGNALS_ID = 0xC0000000;
+
+// Bit 31 of a DBC message ID marks an extended frame
+static constexpr unsigned long DBC_EXTENDED_FLAG = 0x80000000;
+
+DbcDatabase::DbcDatabase()
+{
+    m_standard_index.fill(-1);
+}
+
+int DbcDatabase::load(const std::string& path)
+{
+    std::ifstream file {path};
+    if (!file)
+    {
+        perror("Error opening DBC file");
+        return 1;
+    }
+
+    std::string line;
+    int line_number = 0;
+    bool is_in_skipped_message = false;
+
+    while (std::getline(file, line))
+    {
+        line_number++;
+
+        const char* text = line.c_str();
+        while (*text == ' ' || *text == '\t')
+        {
+            text++;
+        }
+
+        if (std::strncmp(text, "BO_ ", 4) == 0)
+        {
+            size_t count = m_messages.size();
+            if (!parse_message(text, line_number))
+            {
+                return 1;
+            }
+            is_in_skipped_message = m_messages.size() == count;
+        }
+        else if (std::strncmp(text, "SG_ ", 4) == 0)
+        {
+            if (is_in_skipped_message)
+            {
+                continue;
+            }
+
+            if (m_messages.empty())
+            {
+                std::cerr << path << ":" << line_number << ": signal outside of a message" << std::endl;
+                return 1;
+            }
+
+            if (!parse_signal(text, line_number, m_messages.back()))
+            {
+                return 1;
+            }
+        }
+        else if (std::strncmp(text, "SIG_VALTYPE_ ", 13) == 0)
+        {
+            if (!parse_value_type(text, line_number))
+            {
+                return 1;
+            }
+        }
+    }
+
+    compile();
+
+    std::cout << "Loaded " << m_messages.size() << " message(s) with " << m_signal_count << " signal(s) from "
+              << path << std::endl;
+
+    return 0;
+}
+
+bool DbcDatabase::parse_message(const char* line, int line_number)
+{
+    unsigned long raw_id;
+    char name[128];
+    unsigned int length;
+
+    if (std::sscanf(line, "BO_ %lu %127[^: ] : %u", &raw_id, name, &length) != 3)
+    {
+        std::cerr << "DBC line " << line_number << ": malformed message" << std::endl;
+        return false;
+    }
+
+    if (raw_id == DBC_INDEPENDENT_SIGNALS_ID)
+    {
+        return true;
+    }
+
+    DbcMessage message {};
+    bool is_extended = (raw_id & DBC_EXTENDED_FLAG) || (raw_id & ~DBC_EXTENDED_FLAG) > CAN_SFF_MASK;
+    message.id = is_extended ? ((raw_id & CAN_EFF_MASK) | CAN_EFF_FLAG) : raw_id;
+    message.name = name;
+    message.length = length;
+
+    m_messages.push_back(std::move(message));
+
+    return true;
+}
+
+bool DbcDatabase::parse_signal(const char* line, int line_number, DbcMessage& message)
+{
+    DbcSignal signal {};
+    char name[128];
+    int consumed = 0;
+
+    if (std::sscanf(line, "SG_ %127[^: ] %n", name, &consumed) != 1 || consumed == 0)
+    {
+        std::cerr << "DBC line " << line_number << ": malformed signal" << std::endl;
+        return false;
+    }
+    signal.name = name;
+
+    // Optional multiplexer indicator between name and colon: "M" for the selector, "m<value>" for a muxed signal
+    const char* cursor = line + consumed;
+    if (*cursor == 'M')
+    {
+        signal.is_multiplexer = true;
+        cursor++;
+    }
+    else if (*cursor == 'm')
+    {
+        char* end;
+        signal.multiplexer_value = static_cast<int>(std::strtol(cursor + 1, &end, 10));
+        cursor = end;
+
+        // "m3M" marks extended multiplexing, treated as a plain multiplexed signal
+        if (*cursor == 'M')
+        {
+            cursor++;
+        }
+    }
+
+    while (*cursor == ' ')
+    {
+        cursor++;
+    }
+
+    if (*cursor != ':')
+    {
+        std::cerr << "DBC line " << line_number << ": malformed signal " << signal.name << std::endl;
+        return false;
+    }
+
+    char byte_order;
+    char sign;
+    double minimum;
+    double maximum;
+    char unit[64] = "";
+    int count = std::sscanf(cursor + 1, " %u|%u@%c%c (%lf,%lf) [%lf|%lf] \"%63[^\"]\"", &signal.start_bit,
+                            &signal.length, &byte_order, &sign, &signal.scale, &signal.offset, &minimum, &maximum,
+                            unit);
+
+    if (count < 8 || signal.length == 0 || signal.length > 64 || (byte_order != '0' && byte_order != '1') ||
+        (sign != '+' && sign != '-'))
+    {
+        std::cerr << "DBC line " << line_number << ": malformed signal " << signal.name << std::endl;
+        return false;
+    }
+
+    signal.unit = unit;
+    signal.is_big_endian = byte_order == '0';
+    signal.is_signed = sign == '-';
+
+    if (signal.is_multiplexer)
+    {
+        message.multiplexer_index = static_cast<int>(message.signals.size());
+    }
+
+    message.signals.push_back(std::move(signal));
+
+    return true;
+}
+
+bool DbcDatabase::parse_value_type(const char* line, int line_number)
+{
+    unsigned long raw_id;
+    char name[128];
+    int value_type;
+
+    if (std::sscanf(line, "SIG_VALTYPE_ %lu %127[^: ] : %d", &raw_id, name, &value_type) != 3 || value_type < 0 ||
+        value_type > 2)
+    {
+        std::cerr << "DBC line " << line_number << ": malformed signal value type" << std::endl;
+        return false;
+    }
+
+    bool is_extended = (raw_id & DBC_EXTENDED_FLAG) || (raw_id & ~DBC_EXTENDED_FLAG) > CAN_SFF_MASK;
+    DbcMessage* message = find_mutable(is_extended ? ((raw_id & CAN_EFF_MASK) | CAN_EFF_FLAG) : raw_id);
+    if (message == nullptr)
+    {
+        return true;
+    }
+
+    for (DbcSignal& signal : message->signals)
+    {
+        if (signal.name == name)
+        {
+            signal.value_type = static_cast<DbcValueType>(value_type);
+        }
+    }
+
+    return true;
+}
+
+DbcMessage* DbcDatabase::find_mutable(canid_t can_id)
+{
+    for (DbcMessage& message : m_messages)
+    {
+        if (message.id == can_id)
+        {
+            return &message;
+        }
+    }
+
+    return nullptr;
+}
+
+void DbcDatabase::compile()
+{
+    m_standard_index.fill(-1);
+    m_extended_index.clear();
+    m_signal_count = 0;
+    m_max_signals = 0;
+
+    for (size_t i = 0; i < m_messages.size(); i++)
+    {
+        DbcMessage& message = m_messages[i];
+
+        if (message.id & CAN_EFF_FLAG)
+        {
+            m_extended_index[message.id] = static_cast<uint32_t>(i);
+        }
+        else
+        {
+            m_standard_index[message.id] = static_cast<int32_t>(i);
+        }
+
+        for (DbcSignal& signal : message.signals)
+        {
+            compile_signal(signal);
+        }
+
+        m_signal_count += message.signals.size();
+        m_max_signals = std::max(m_max_signals, message.signals.size());
+    }
+}
+
+void DbcDatabase::compile_signal(DbcSignal& signal)
+{
+    signal.mask = signal.length == 64 ? UINT64_MAX : (1ULL << signal.length) - 1;
+    signal.byte_offset = signal.start_bit / 8;
+
+    if (signal.is_big_endian)
+    {
+        // start_bit is the MSB. In the big-endian word loaded at the MSB's byte it sits (7 - bit) from the top.
+        unsigned int top = 7 - signal.start_bit % 8;
+        signal.shift = top + signal.length <= 64 ? 64 - top - signal.length : 0;
+        signal.required_length = signal.byte_offset + (top + signal.length + 7) / 8;
+    }
+    else
+    {
+        signal.shift = signal.start_bit % 8;
+        signal.required_length = (signal.start_bit + signal.length + 7) / 8;
+    }
+}
+
+uint64_t DbcDatabase::extract(const DbcSignal& signal, const uint8_t* data)
+{
+    // Common case: the signal fits in the 8 bytes starting at its first byte
+    if (signal.required_length - signal.byte_offset <= 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data + signal.byte_offset, sizeof(word));
+        word = signal.is_big_endian ? be64toh(word) : le64toh(word);
+        return (word >> signal.shift) & signal.mask;
+    }
+
+    // Long unaligned signals spread over 9 bytes, walk them bit by bit
+    uint64_t raw = 0;
+    unsigned int position = signal.start_bit;
+    for (unsigned int i = 0; i < signal.length; i++)
+    {
+        uint64_t bit = (data[position / 8] >> (position % 8)) & 1;
+        if (signal.is_big_endian)
+        {
+            raw = raw << 1 | bit;
+            position = position % 8 == 0 ? position + 15 : position - 1;
+        }
+        else
+        {
+            raw |= bit << i;
+            position++;
+        }
+    }
+
+    return raw;
+}
+
+const DbcMessage* DbcDatabase::find(canid_t can_id) const
+{
+    if (can_id & (CAN_ERR_FLAG | CAN_RTR_FLAG))
+    {
+        return nullptr;
+    }
+
+    if (can_id & CAN_EFF_FLAG)
+    {
+        auto entry = m_extended_index.find(can_id);
+        return entry == m_extended_index.end() ? nullptr : &m_messages[entry->second];
+    }
+
+    int32_t index = m_standard_index[can_id & CAN_SFF_MASK];
+    return index < 0 ? nullptr : &m_messages[static_cast<size_t>(index)];
+}
+
+size_t DbcDatabase::decode(const DbcMessage& message, const canfd_frame& frame, double* values) const
+{
+    // Zero padded copy so the 8 byte loads of signals near the end stay inside the buffer
+    uint8_t data[CANFD_MAX_DLEN + 8] = {};
+    std::memcpy(data, frame.data, CANFD_MAX_DLEN);
+
+    int64_t multiplexer = -1;
+    if (message.multiplexer_index >= 0)
+    {
+        const DbcSignal& selector = message.signals[static_cast<size_t>(message.multiplexer_index)];
+        if (selector.required_length <= frame.len)
+        {
+            multiplexer = static_cast<int64_t>(extract(selector, data));
+        }
+    }
+
+    size_t decoded = 0;
+    for (size_t i = 0; i < message.signals.size(); i++)
+    {
+        const DbcSignal& signal = message.signals[i];
+
+        if (signal.required_length > frame.len ||
+            (signal.multiplexer_value >= 0 && signal.multiplexer_value != multiplexer))
+        {
+            values[i] = NAN;
+            continue;
+        }
+
+        uint64_t raw = extract(signal, data);
+        double value;
+
+        switch (signal.value_type)
+        {
+        case DbcValueType::Float:
+        {
+            uint32_t bits = static_cast<uint32_t>(raw);
+            float number;
+            std::memcpy(&number, &bits, sizeof(number));
+            value = number;
+            break;
+        }
+        case DbcValueType::Double:
+            std::memcpy(&value, &raw, sizeof(value));
+            break;
+        case DbcValueType::Integer:
+        default:
+            if (signal.is_signed && signal.length < 64 && ((raw >> (signal.length - 1)) & 1))
+            {
+                raw |= ~signal.mask;
+            }
+            value = signal.is_signed ? static_cast<double>(static_cast<int64_t>(raw)) : static_cast<double>(raw);
+            break;
+        }
+
+        values[i] = value * signal.scale + signal.offset;
+        decoded++;
+    }
+
+    return decoded;
+}
+
+size_t DbcDatabase::message_count() const
+{
+    return m_messages.size();
+}
+
+size_t DbcDatabase::signal_count() const
+{
+    return m_signal_count;
+}
+
+size_t DbcDatabase::max_signals() const
+{
+    return m_max_signals;
+}
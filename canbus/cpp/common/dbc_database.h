@@ -0,0 +1,105 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DBC_DATABASE_H
+#define DBC_DATABASE_H
+
+#include <linux/can.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class DbcValueType
+{
+    Integer,
+    Float,  // IEEE 754 single precision, SIG_VALTYPE_ 1
+    Double, // IEEE 754 double precision, SIG_VALTYPE_ 2
+};
+
+// One signal with its bit position reduced to a shift of a 64 bit word loaded at byte_offset
+struct DbcSignal
+{
+    std::string name {};
+    std::string unit {};
+    double scale {1.0};
+    double offset {0.0};
+
+    unsigned int start_bit {0}; // As written in the DBC file, LSB for Intel and MSB for Motorola byte order
+    unsigned int length {0};
+    bool is_big_endian {false};
+    bool is_signed {false};
+    DbcValueType value_type {DbcValueType::Integer};
+
+    // Multiplexing: the selector signal of its message, or a signal only present for one selector value
+    bool is_multiplexer {false};
+    int multiplexer_value {-1};
+
+    // Precomputed by DbcDatabase, see decode()
+    unsigned int byte_offset {0};
+    unsigned int shift {0};
+    uint64_t mask {0};
+    unsigned int required_length {0}; // Frame bytes needed to hold the signal
+};
+
+struct DbcMessage
+{
+    canid_t id {0}; // With CAN_EFF_FLAG for extended IDs
+    std::string name {};
+    unsigned int length {0};
+    std::vector<DbcSignal> signals {};
+    int multiplexer_index {-1}; // Index of the selector signal, -1 when not multiplexed
+};
+
+// Messages and signals of a DBC file, compiled into a table that finds a frame's message with one array index
+// (standard IDs) or one hash lookup (extended IDs) and decodes each signal with a load, a shift and a mask.
+class DbcDatabase
+{
+  public:
+    DbcDatabase();
+
+    int load(const std::string& path);
+
+    const DbcMessage* find(canid_t can_id) const;
+
+    // Writes the physical value of every signal of message to values, in signal order. Signals the frame is too
+    // short for, or whose multiplexer value does not match, are set to NaN. Returns the number decoded.
+    size_t decode(const DbcMessage& message, const canfd_frame& frame, double* values) const;
+
+    size_t message_count() const;
+    size_t signal_count() const;
+    size_t max_signals() const; // Most signals in one message, the size values must have
+
+  private:
+    std::vector<DbcMessage> m_messages {};
+    std::array<int32_t, CAN_SFF_MASK + 1> m_standard_index {};
+    std::unordered_map<canid_t, uint32_t> m_extended_index {};
+    size_t m_signal_count {0};
+    size_t m_max_signals {0};
+
+    bool parse_message(const char* line, int line_number);
+    bool parse_signal(const char* line, int line_number, DbcMessage& message);
+    bool parse_value_type(const char* line, int line_number);
+    DbcMessage* find_mutable(canid_t can_id);
+    void compile();
+    static void compile_signal(DbcSignal& signal);
+    static uint64_t extract(const DbcSignal& signal, const uint8_t* data);
+};
+
+#endif // DBC_DATABASE_H
@@ -0,0 +1,289 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "frame_datagram.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <endian.h>
+#include <iostream>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static int open_unix_socket(const std::string& path, bool is_receiver)
+{
+    struct sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "Invalid Unix socket path: " << path << std::endl;
+        return -1;
+    }
+
+    // Abstract addresses start with a NUL byte and are not NUL terminated
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    if (path[0] == '@')
+    {
+        addr.sun_path[0] = '\0';
+    }
+    socklen_t length = static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + path.size());
+
+    int datagram_socket = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (datagram_socket < 0)
+    {
+        perror("Error while opening socket");
+        return -1;
+    }
+
+    if (is_receiver && path[0] != '@')
+    {
+        unlink(path.c_str());
+    }
+
+    int result = is_receiver ? bind(datagram_socket, reinterpret_cast<struct sockaddr*>(&addr), length)
+                             : connect(datagram_socket, reinterpret_cast<struct sockaddr*>(&addr), length);
+    if (result < 0)
+    {
+        perror(is_receiver ? "Error in socket bind" : "Error connecting socket");
+        close(datagram_socket);
+        return -1;
+    }
+
+    return datagram_socket;
+}
+
+static int open_udp_socket(const std::string& address, bool is_receiver)
+{
+    size_t colon = address.rfind(':');
+    std::string host = colon == std::string::npos ? std::string {} : address.substr(0, colon);
+    std::string port = colon == std::string::npos ? address : address.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']')
+    {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    if (port.empty() || (host.empty() && !is_receiver))
+    {
+        std::cerr << "Invalid UDP address, expected HOST:PORT: " << address << std::endl;
+        return -1;
+    }
+
+    struct addrinfo hints {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = is_receiver ? AI_PASSIVE : 0;
+
+    struct addrinfo* results = nullptr;
+    int error = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &results);
+    if (error != 0)
+    {
+        std::cerr << "Error resolving " << address << ": " << gai_strerror(error) << std::endl;
+        return -1;
+    }
+
+    int datagram_socket = -1;
+    for (struct addrinfo* result = results; result != nullptr; result = result->ai_next)
+    {
+        datagram_socket = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+        if (datagram_socket < 0)
+        {
+            continue;
+        }
+
+        if ((is_receiver ? bind(datagram_socket, result->ai_addr, result->ai_addrlen)
+                         : connect(datagram_socket, result->ai_addr, result->ai_addrlen)) == 0)
+        {
+            break;
+        }
+
+        close(datagram_socket);
+        datagram_socket = -1;
+    }
+    freeaddrinfo(results);
+
+    if (datagram_socket < 0)
+    {
+        perror(is_receiver ? "Error in socket bind" : "Error connecting socket");
+    }
+
+    return datagram_socket;
+}
+
+int open_datagram_socket(const DatagramEndpoint& endpoint, bool is_receiver)
+{
+    return endpoint.is_unix ? open_unix_socket(endpoint.address, is_receiver)
+                            : open_udp_socket(endpoint.address, is_receiver);
+}
+
+DatagramEncoder::DatagramEncoder(size_t capacity, const std::string& interface_name)
+    : m_buffer(std::clamp(capacity, sizeof(DatagramHeader) + DATAGRAM_RECORD_HEADER_SIZE + CANFD_MAX_DLEN,
+                          DATAGRAM_MAX_SIZE))
+{
+    DatagramHeader header {};
+    std::memcpy(header.magic, DATAGRAM_MAGIC, sizeof(header.magic));
+    header.version = htole16(DATAGRAM_VERSION);
+    std::strncpy(header.interface_name, interface_name.c_str(), IFNAMSIZ - 1);
+    std::memcpy(m_buffer.data(), &header, sizeof(header));
+}
+
+bool DatagramEncoder::add(const CaptureRecord& record)
+{
+    size_t length = std::min<size_t>(record.len, CANFD_MAX_DLEN);
+    if (m_size + DATAGRAM_RECORD_HEADER_SIZE + length > m_buffer.size())
+    {
+        return false;
+    }
+
+    uint8_t* out = m_buffer.data() + m_size;
+    uint64_t timestamp_ns = htole64(record.timestamp_ns);
+    uint32_t can_id = htole32(record.can_id);
+    std::memcpy(out + DATAGRAM_RECORD_TIMESTAMP, &timestamp_ns, sizeof(timestamp_ns));
+    std::memcpy(out + DATAGRAM_RECORD_CAN_ID, &can_id, sizeof(can_id));
+    out[DATAGRAM_RECORD_LEN] = static_cast<uint8_t>(length);
+    out[DATAGRAM_RECORD_FLAGS] = record.record_flags;
+    out[DATAGRAM_RECORD_FD_FLAGS] = record.fd_flags;
+    std::memcpy(out + DATAGRAM_RECORD_HEADER_SIZE, record.data, length);
+
+    m_size += DATAGRAM_RECORD_HEADER_SIZE + length;
+    m_frame_count++;
+    return true;
+}
+
+void DatagramEncoder::finish(uint32_t sequence)
+{
+    uint16_t frame_count = htole16(m_frame_count);
+    uint32_t sequence_le = htole32(sequence);
+    std::memcpy(m_buffer.data() + offsetof(DatagramHeader, frame_count), &frame_count, sizeof(frame_count));
+    std::memcpy(m_buffer.data() + offsetof(DatagramHeader, sequence), &sequence_le, sizeof(sequence_le));
+}
+
+void DatagramEncoder::reset()
+{
+    m_size = sizeof(DatagramHeader);
+    m_frame_count = 0;
+}
+
+const uint8_t* DatagramEncoder::data() const
+{
+    return m_buffer.data();
+}
+
+size_t DatagramEncoder::size() const
+{
+    return m_size;
+}
+
+size_t DatagramEncoder::capacity() const
+{
+    return m_buffer.size();
+}
+
+uint16_t DatagramEncoder::frame_count() const
+{
+    return m_frame_count;
+}
+
+bool DatagramDecoder::open(const uint8_t* data, size_t size)
+{
+    if (size < sizeof(DatagramHeader))
+    {
+        return false;
+    }
+
+    std::memcpy(&m_header, data, sizeof(m_header));
+    if (std::memcmp(m_header.magic, DATAGRAM_MAGIC, sizeof(m_header.magic)) != 0 ||
+        le16toh(m_header.version) != DATAGRAM_VERSION)
+    {
+        return false;
+    }
+
+    m_header.frame_count = le16toh(m_header.frame_count);
+    m_header.sequence = le32toh(m_header.sequence);
+    m_header.interface_name[IFNAMSIZ - 1] = '\0';
+
+    // The records must fill the datagram exactly and match the header's frame count, anything else was cut
+    // short, padded or corrupted on the way
+    size_t offset = sizeof(DatagramHeader);
+    size_t record_count = 0;
+    while (offset + DATAGRAM_RECORD_HEADER_SIZE <= size)
+    {
+        size_t length = data[offset + DATAGRAM_RECORD_LEN];
+        if (length > CANFD_MAX_DLEN || offset + DATAGRAM_RECORD_HEADER_SIZE + length > size)
+        {
+            break;
+        }
+        offset += DATAGRAM_RECORD_HEADER_SIZE + length;
+        record_count++;
+    }
+    if (offset != size || record_count != m_header.frame_count)
+    {
+        return false;
+    }
+
+    m_data = data;
+    m_size = size;
+    m_offset = sizeof(DatagramHeader);
+    return true;
+}
+
+bool DatagramDecoder::next(CaptureRecord& record)
+{
+    if (m_offset + DATAGRAM_RECORD_HEADER_SIZE > m_size)
+    {
+        return false;
+    }
+
+    const uint8_t* in = m_data + m_offset;
+    size_t length = in[DATAGRAM_RECORD_LEN];
+    if (length > CANFD_MAX_DLEN || m_offset + DATAGRAM_RECORD_HEADER_SIZE + length > m_size)
+    {
+        return false;
+    }
+
+    uint64_t timestamp_ns;
+    uint32_t can_id;
+    std::memcpy(&timestamp_ns, in + DATAGRAM_RECORD_TIMESTAMP, sizeof(timestamp_ns));
+    std::memcpy(&can_id, in + DATAGRAM_RECORD_CAN_ID, sizeof(can_id));
+
+    record = {};
+    record.timestamp_ns = le64toh(timestamp_ns);
+    record.can_id = le32toh(can_id);
+    record.len = static_cast<uint8_t>(length);
+    record.record_flags = in[DATAGRAM_RECORD_FLAGS];
+    record.fd_flags = in[DATAGRAM_RECORD_FD_FLAGS];
+    std::memcpy(record.data, in + DATAGRAM_RECORD_HEADER_SIZE, length);
+
+    m_offset += DATAGRAM_RECORD_HEADER_SIZE + length;
+    return true;
+}
+
+uint32_t DatagramDecoder::sequence() const
+{
+    return m_header.sequence;
+}
+
+uint16_t DatagramDecoder::frame_count() const
+{
+    return m_header.frame_count;
+}
+
+const char* DatagramDecoder::interface_name() const
+{
+    return m_header.interface_name;
+}
@@ -0,0 +1,116 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FRAME_DATAGRAM_H
+#define FRAME_DATAGRAM_H
+
+#include "can_capture.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bridge datagram layout, little-endian:
+//
+//   DatagramHeader                      32 bytes
+//   frame records, back to back         15 bytes + len each
+//
+// A record is timestamp_ns (8), can_id (4), len (1), CaptureRecord::record_flags (1) and canfd_frame::flags (1),
+// followed by len payload bytes. Receivers tell lost datagrams by gaps in the sequence number.
+
+constexpr char DATAGRAM_MAGIC[4] = {'T', '3', 'C', 'B'};
+constexpr uint16_t DATAGRAM_VERSION = 1;
+constexpr size_t DATAGRAM_MAX_SIZE = 65507; // Largest UDP payload over IPv4
+
+// Field offsets within a record, the payload follows at DATAGRAM_RECORD_HEADER_SIZE
+constexpr size_t DATAGRAM_RECORD_TIMESTAMP = 0;
+constexpr size_t DATAGRAM_RECORD_CAN_ID = 8;
+constexpr size_t DATAGRAM_RECORD_LEN = 12;
+constexpr size_t DATAGRAM_RECORD_FLAGS = 13;
+constexpr size_t DATAGRAM_RECORD_FD_FLAGS = 14;
+constexpr size_t DATAGRAM_RECORD_HEADER_SIZE = 15;
+
+struct DatagramHeader
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t frame_count;
+    uint32_t sequence;
+    uint32_t reserved;
+    char interface_name[IFNAMSIZ]; // Interface the frames were received on
+};
+
+static_assert(sizeof(DatagramHeader) == 32, "DatagramHeader layout changed");
+
+// Where bridge datagrams go: a UDP "HOST:PORT" ("[ADDRESS]:PORT" for IPv6) or a Unix datagram socket path,
+// '@' at the start of the path selects the abstract namespace. Receivers may give a UDP port alone.
+struct DatagramEndpoint
+{
+    bool is_unix;
+    std::string address;
+};
+
+// Returns a datagram socket connected to the endpoint, or bound to it with is_receiver, -1 on error
+int open_datagram_socket(const DatagramEndpoint& endpoint, bool is_receiver);
+
+// Packs frames into one datagram at a time
+class DatagramEncoder
+{
+  public:
+    DatagramEncoder(size_t capacity, const std::string& interface_name);
+
+    // Returns false when the frame does not fit, the datagram has to be sent and reset first
+    bool add(const CaptureRecord& record);
+
+    // Fills in the header, the datagram is then data()[0, size())
+    void finish(uint32_t sequence);
+    void reset();
+
+    const uint8_t* data() const;
+    size_t size() const;
+    size_t capacity() const;
+    uint16_t frame_count() const;
+
+  private:
+    std::vector<uint8_t> m_buffer {};
+    size_t m_size {sizeof(DatagramHeader)};
+    uint16_t m_frame_count {0};
+};
+
+// Reads the frames of one received datagram
+class DatagramDecoder
+{
+  public:
+    // Returns false for anything that is not a bridge datagram of this version, or whose records do not match
+    // the frame count of its header
+    bool open(const uint8_t* data, size_t size);
+
+    // Returns false after the last frame
+    bool next(CaptureRecord& record);
+
+    uint32_t sequence() const;
+    uint16_t frame_count() const;
+    const char* interface_name() const;
+
+  private:
+    const uint8_t* m_data {nullptr};
+    size_t m_size {0};
+    size_t m_offset {0};
+    DatagramHeader m_header {};
+};
+
+#endif // FRAME_DATAGRAM_H
@@ -0,0 +1,179 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "frame_dispatcher.h"
+#include <utility>
+
+FrameDispatcher::FrameDispatcher() : m_extended_slots(EXTENDED_CAPACITY) {}
+
+int FrameDispatcher::add(canid_t can_id, FrameHandler handler)
+{
+    return add(can_id, CAN_EFF_FLAG | CAN_EFF_MASK, std::move(handler));
+}
+
+int FrameDispatcher::add(canid_t can_id, canid_t mask, FrameHandler handler)
+{
+    bool is_extended = can_id & CAN_EFF_FLAG;
+    canid_t id_mask = is_extended ? CAN_EFF_MASK : CAN_SFF_MASK;
+    Registration registration {can_id & id_mask, mask & id_mask, is_extended, (mask & id_mask) != id_mask};
+
+    // Exact extended IDs take their slot right away, so a full table is reported by the add() that overflows it.
+    // Keep it at most half full so lookups stay within a few probes.
+    if (is_extended && !registration.is_range)
+    {
+        ExtendedSlot* slot = find_slot(registration.can_id | CAN_EFF_FLAG);
+        if (slot->can_id == 0)
+        {
+            if (m_extended_count >= EXTENDED_CAPACITY / 2)
+            {
+                return 1;
+            }
+            slot->can_id = registration.can_id | CAN_EFF_FLAG;
+            m_extended_count++;
+        }
+    }
+
+    if (is_extended && registration.is_range)
+    {
+        m_extended_ranges.push_back(static_cast<uint32_t>(m_registrations.size()));
+    }
+
+    m_registrations.push_back(registration);
+    m_handlers.push_back(std::move(handler));
+    m_is_compiled = false;
+
+    return 0;
+}
+
+void FrameDispatcher::compile()
+{
+    if (m_is_compiled)
+    {
+        return;
+    }
+
+    m_chain.clear();
+
+    for (canid_t can_id = 0; can_id <= CAN_SFF_MASK; can_id++)
+    {
+        m_standard_routes[can_id] = compile_route(can_id, false);
+    }
+
+    // Ranges covering an exact extended ID are compiled into its route as well, see compile_route()
+    for (ExtendedSlot& slot : m_extended_slots)
+    {
+        if (slot.can_id != 0)
+        {
+            slot.route = compile_route(slot.can_id & CAN_EFF_MASK, true);
+        }
+    }
+
+    m_is_compiled = true;
+}
+
+FrameDispatcher::Route FrameDispatcher::compile_route(canid_t can_id, bool is_extended)
+{
+    Route route {static_cast<uint32_t>(m_chain.size()), 0};
+
+    for (uint32_t i = 0; i < m_registrations.size(); i++)
+    {
+        const Registration& registration = m_registrations[i];
+        if (registration.is_extended == is_extended &&
+            (can_id & registration.mask) == (registration.can_id & registration.mask))
+        {
+            m_chain.push_back(i);
+            route.count++;
+        }
+    }
+
+    return route;
+}
+
+// Returns the slot holding can_id, or the free slot it would go to, nullptr when neither is found
+FrameDispatcher::ExtendedSlot* FrameDispatcher::find_slot(canid_t can_id)
+{
+    return const_cast<ExtendedSlot*>(std::as_const(*this).find_slot(can_id));
+}
+
+const FrameDispatcher::ExtendedSlot* FrameDispatcher::find_slot(canid_t can_id) const
+{
+    size_t mask = EXTENDED_CAPACITY - 1;
+    size_t slot = (static_cast<uint32_t>(can_id * 0x9E3779B1U) >> 16) & mask;
+
+    for (size_t probe = 0; probe < EXTENDED_CAPACITY; probe++)
+    {
+        const ExtendedSlot& entry = m_extended_slots[(slot + probe) & mask];
+        if (entry.can_id == can_id || entry.can_id == 0)
+        {
+            return &entry;
+        }
+    }
+
+    return nullptr;
+}
+
+size_t FrameDispatcher::dispatch(const ReceivedFrame& received)
+{
+    if (!m_is_compiled)
+    {
+        compile();
+    }
+
+    canid_t can_id = received.frame.can_id;
+    if (can_id & CAN_ERR_FLAG)
+    {
+        return 0;
+    }
+
+    Route route;
+    if (!(can_id & CAN_EFF_FLAG))
+    {
+        route = m_standard_routes[can_id & CAN_SFF_MASK];
+    }
+    else
+    {
+        const ExtendedSlot* slot = find_slot(can_id & (CAN_EFF_FLAG | CAN_EFF_MASK));
+        if (slot == nullptr || slot->can_id == 0)
+        {
+            // No exact registration, only the extended ranges can match
+            size_t count = 0;
+            for (uint32_t index : m_extended_ranges)
+            {
+                const Registration& registration = m_registrations[index];
+                if (((can_id & CAN_EFF_MASK) & registration.mask) == (registration.can_id & registration.mask))
+                {
+                    m_handlers[index](received);
+                    count++;
+                }
+            }
+            return count;
+        }
+        route = slot->route;
+    }
+
+    for (uint32_t i = 0; i < route.count; i++)
+    {
+        m_handlers[m_chain[route.first + i]](received);
+    }
+
+    return route.count;
+}
+
+bool FrameDispatcher::empty() const
+{
+    return m_handlers.empty();
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FRAME_DISPATCHER_H
+#define FRAME_DISPATCHER_H
+
+#include "received_frame.h"
+#include <linux/can.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+using FrameHandler = std::function<void(const ReceivedFrame&)>;
+
+// Maps CAN IDs to handlers. Every registration is compiled into per-ID handler lists, so a frame finds its
+// handlers with one index into a dense table (standard IDs) or a short probe of an open-addressing table
+// (extended IDs). Only extended ID/mask ranges are matched one by one, for IDs no exact registration covers.
+class FrameDispatcher
+{
+  public:
+    // Open-addressing slots for extended IDs with an exact registration, a power of two
+    static constexpr size_t EXTENDED_CAPACITY = 1024;
+
+    FrameDispatcher();
+
+    // Set CAN_EFF_FLAG in can_id for extended IDs. A frame matches when (frame_id & mask) == (can_id & mask),
+    // a frame matching several registrations runs their handlers in registration order. Returns 1 when the
+    // extended table is full.
+    int add(canid_t can_id, FrameHandler handler);
+    int add(canid_t can_id, canid_t mask, FrameHandler handler);
+
+    // Builds the per-ID handler lists from all registrations so far. Call it once after the last add(), otherwise
+    // the first dispatch() does.
+    void compile();
+
+    // Runs the handlers of the frame's ID and returns their number. Error frames have no handlers.
+    size_t dispatch(const ReceivedFrame& received);
+
+    bool empty() const;
+
+  private:
+    // Handlers of one ID, a range of m_chain
+    struct Route
+    {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    struct ExtendedSlot
+    {
+        canid_t can_id; // With CAN_EFF_FLAG, 0 marks a free slot
+        Route route;
+    };
+
+    struct Registration
+    {
+        canid_t can_id;
+        canid_t mask;
+        bool is_extended;
+        bool is_range; // Mask leaves bits open, extended ranges are not expanded into the table
+    };
+
+    std::vector<Registration> m_registrations {};
+    std::vector<FrameHandler> m_handlers {}; // Parallel to m_registrations
+    std::vector<uint32_t> m_chain {};        // Handler indices of every route
+    std::array<Route, CAN_SFF_MASK + 1> m_standard_routes {};
+    std::vector<ExtendedSlot> m_extended_slots {};
+    std::vector<uint32_t> m_extended_ranges {}; // Registrations matched by mask for IDs not in the table
+    size_t m_extended_count {0};
+    bool m_is_compiled {true};
+
+    Route compile_route(canid_t can_id, bool is_extended);
+    ExtendedSlot* find_slot(canid_t can_id);
+    const ExtendedSlot* find_slot(canid_t can_id) const;
+};
+
+#endif // FRAME_DISPATCHER_H
@@ -0,0 +1,81 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "hex_parse.h"
+#include <cctype>
+#include <utility>
+
+static int hex_digit(char c)
+{
+    unsigned char digit = static_cast<unsigned char>(c);
+    if (!std::isxdigit(digit))
+    {
+        return -1;
+    }
+    return std::isdigit(digit) ? digit - '0' : std::tolower(digit) - 'a' + 10;
+}
+
+bool parse_hex(std::string_view text, uint64_t max, uint64_t& value)
+{
+    if (text.empty())
+    {
+        return false;
+    }
+
+    uint64_t result = 0;
+    for (char c : text)
+    {
+        int digit = hex_digit(c);
+        if (digit < 0 || result > (max >> 4))
+        {
+            return false;
+        }
+        result = (result << 4) | static_cast<uint64_t>(digit);
+        if (result > max)
+        {
+            return false;
+        }
+    }
+
+    value = result;
+    return true;
+}
+
+bool parse_hex_bytes(std::string_view text, size_t max_size, std::vector<uint8_t>& bytes)
+{
+    if (text.empty() || text.size() % 2 != 0 || text.size() / 2 > max_size)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> result;
+    result.reserve(text.size() / 2);
+    for (size_t i = 0; i < text.size(); i += 2)
+    {
+        int high = hex_digit(text[i]);
+        int low = hex_digit(text[i + 1]);
+        if (high < 0 || low < 0)
+        {
+            return false;
+        }
+        result.push_back(static_cast<uint8_t>((high << 4) | low));
+    }
+
+    bytes = std::move(result);
+    return true;
+}
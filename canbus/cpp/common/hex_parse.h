@@ -0,0 +1,36 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef HEX_PARSE_H
+#define HEX_PARSE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Command line and route hex values take hex digits only: no sign, whitespace or 0x prefix, which strtoul() would
+// silently accept
+
+// Parses a hex number of at most max
+bool parse_hex(std::string_view text, uint64_t max, uint64_t& value);
+
+// Parses pairs of hex digits, one byte each, into 1 to max_size bytes
+bool parse_hex_bytes(std::string_view text, size_t max_size, std::vector<uint8_t>& bytes);
+
+#endif // HEX_PARSE_H
@@ -0,0 +1,58 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hw_timestamp.h"
+#include <cstdio>
+#include <cstring>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+
+bool enable_hw_timestamps(int socket, const std::string& interface_name, bool is_tx, HwTimestampConfig& saved)
+{
+    struct ifreq ifr {};
+    std::strncpy(ifr.ifr_name, interface_name.c_str(), IFNAMSIZ - 1);
+
+    // Drivers without SIOCGHWTSTAMP have timestamping off, which the zeroed config restores
+    struct hwtstamp_config previous {};
+    ifr.ifr_data = reinterpret_cast<char*>(&previous);
+    ioctl(socket, SIOCGHWTSTAMP, &ifr);
+
+    struct hwtstamp_config config {};
+    config.tx_type = is_tx ? HWTSTAMP_TX_ON : previous.tx_type;
+    config.rx_filter = HWTSTAMP_FILTER_ALL;
+    ifr.ifr_data = reinterpret_cast<char*>(&config);
+    if (ioctl(socket, SIOCSHWTSTAMP, &ifr) < 0)
+    {
+        return false;
+    }
+
+    saved = {interface_name, previous};
+    return true;
+}
+
+void restore_hw_timestamps(int socket, const HwTimestampConfig& saved)
+{
+    struct ifreq ifr {};
+    struct hwtstamp_config previous = saved.previous;
+    std::strncpy(ifr.ifr_name, saved.interface_name.c_str(), IFNAMSIZ - 1);
+    ifr.ifr_data = reinterpret_cast<char*>(&previous);
+    if (ioctl(socket, SIOCSHWTSTAMP, &ifr) < 0)
+    {
+        perror("Warning: could not restore the hardware timestamping setting");
+    }
+}
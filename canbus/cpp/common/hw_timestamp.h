@@ -0,0 +1,39 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef HW_TIMESTAMP_H
+#define HW_TIMESTAMP_H
+
+#include <linux/net_tstamp.h>
+#include <string>
+
+// Hardware timestamping is a setting of the network interface, not of the socket, so switching it on affects every
+// user of the interface and needs CAP_NET_ADMIN. The previous setting is saved to be restored on exit.
+struct HwTimestampConfig
+{
+    std::string interface_name {};
+    struct hwtstamp_config previous {};
+};
+
+// Switches receive timestamping, and transmit timestamping with is_tx, on for all frames of the interface. Returns
+// false when the driver does not support it or the call is not permitted, saved is then left unchanged.
+bool enable_hw_timestamps(int socket, const std::string& interface_name, bool is_tx, HwTimestampConfig& saved);
+
+// Restores the setting saved by enable_hw_timestamps()
+void restore_hw_timestamps(int socket, const HwTimestampConfig& saved);
+
+#endif // HW_TIMESTAMP_H
@@ -0,0 +1,184 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "isotp_socket.h"
+#include <cstdio>
+#include <cstdlib>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+uint8_t encode_isotp_stmin(unsigned int microseconds)
+{
+    if (microseconds == 0)
+    {
+        return 0;
+    }
+
+    if (microseconds <= 900)
+    {
+        return static_cast<uint8_t>(0xF0 + (microseconds + 99) / 100);
+    }
+
+    unsigned int milliseconds = (microseconds + 999) / 1000;
+    return static_cast<uint8_t>(milliseconds > 0x7F ? 0x7F : milliseconds);
+}
+
+bool parse_isotp_ids(const std::string& text, IsoTpOptions& options)
+{
+    size_t separator = text.find(':');
+    if (separator == std::string::npos || separator == 0 || separator == text.size() - 1)
+    {
+        return false;
+    }
+
+    char* end;
+    unsigned long tx_id = std::strtoul(text.c_str(), &end, 16);
+    if (end != text.c_str() + separator || tx_id > CAN_EFF_MASK)
+    {
+        return false;
+    }
+
+    unsigned long rx_id = std::strtoul(text.c_str() + separator + 1, &end, 16);
+    if (*end != '\0' || rx_id > CAN_EFF_MASK)
+    {
+        return false;
+    }
+
+    options.tx_id = static_cast<canid_t>(tx_id) | (tx_id > CAN_SFF_MASK ? CAN_EFF_FLAG : 0);
+    options.rx_id = static_cast<canid_t>(rx_id) | (rx_id > CAN_SFF_MASK ? CAN_EFF_FLAG : 0);
+
+    return true;
+}
+
+IsoTpSocket::IsoTpSocket() {}
+
+IsoTpSocket::~IsoTpSocket()
+{
+    close();
+}
+
+int IsoTpSocket::open(const std::string& interface_name, const IsoTpOptions& options)
+{
+    struct sockaddr_can addr {};
+
+    m_socket = ::socket(PF_CAN, SOCK_DGRAM, CAN_ISOTP);
+    if (m_socket < 0)
+    {
+        perror("Error opening ISO-TP socket (is the can-isotp module loaded?)");
+        return 1;
+    }
+
+    if (setup_options(options))
+    {
+        close();
+        return 1;
+    }
+
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = static_cast<int>(if_nametoindex(interface_name.c_str()));
+    addr.can_addr.tp.tx_id = options.tx_id;
+    addr.can_addr.tp.rx_id = options.rx_id;
+
+    if (addr.can_ifindex == 0)
+    {
+        perror("Error getting interface index");
+        close();
+        return 1;
+    }
+
+    if (bind(m_socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        perror("Error in ISO-TP socket bind");
+        close();
+        return 1;
+    }
+
+    return 0;
+}
+
+int IsoTpSocket::setup_options(const IsoTpOptions& options)
+{
+    struct can_isotp_options isotp_options {};
+    struct can_isotp_fc_options fc_options {};
+
+    // Waiting for the transfer to finish makes send() timing match what is on the bus
+    isotp_options.flags = CAN_ISOTP_WAIT_TX_DONE;
+    isotp_options.frame_txtime = CAN_ISOTP_DEFAULT_FRAME_TXTIME;
+    isotp_options.txpad_content = options.padding_byte;
+    isotp_options.rxpad_content = options.padding_byte;
+    if (options.use_padding)
+    {
+        isotp_options.flags |= CAN_ISOTP_TX_PADDING;
+    }
+
+    if (setsockopt(m_socket, SOL_CAN_ISOTP, CAN_ISOTP_OPTS, &isotp_options, sizeof(isotp_options)) < 0)
+    {
+        perror("Error setting ISO-TP options");
+        return 1;
+    }
+
+    fc_options.bs = options.block_size;
+    fc_options.stmin = options.stmin;
+    fc_options.wftmax = CAN_ISOTP_DEFAULT_RECV_WFTMAX;
+
+    if (setsockopt(m_socket, SOL_CAN_ISOTP, CAN_ISOTP_RECV_FC, &fc_options, sizeof(fc_options)) < 0)
+    {
+        perror("Error setting ISO-TP flow control");
+        return 1;
+    }
+
+    if (options.is_fd)
+    {
+        struct can_isotp_ll_options ll_options {};
+        ll_options.mtu = CANFD_MTU;
+        ll_options.tx_dl = CANFD_MAX_DLEN;
+        ll_options.tx_flags = 0;
+
+        if (setsockopt(m_socket, SOL_CAN_ISOTP, CAN_ISOTP_LL_OPTS, &ll_options, sizeof(ll_options)) < 0)
+        {
+            perror("Error enabling CAN FD for ISO-TP");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void IsoTpSocket::close()
+{
+    if (m_socket >= 0)
+    {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+}
+
+ssize_t IsoTpSocket::send(const uint8_t* data, size_t length)
+{
+    return write(m_socket, data, length);
+}
+
+ssize_t IsoTpSocket::receive(uint8_t* data, size_t capacity)
+{
+    return read(m_socket, data, capacity);
+}
+
+int IsoTpSocket::socket() const
+{
+    return m_socket;
+}
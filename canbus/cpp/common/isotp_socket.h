@@ -0,0 +1,81 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ISOTP_SOCKET_H
+#define ISOTP_SOCKET_H
+
+#include <linux/can.h>
+#include <linux/can/isotp.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+// Largest message with the 12 bit length of a classic ISO 15765-2 first frame
+constexpr size_t ISOTP_MAX_PAYLOAD = 4095;
+
+struct IsoTpOptions
+{
+    canid_t tx_id {0x7E0}; // Frames we send, IDs above 0x7FF are extended
+    canid_t rx_id {0x7E8}; // Frames we accept, including flow control for our own transfers
+
+    // Flow control we send while receiving: consecutive frames the peer sends between flow control frames (0 = all
+    // of them) and the gap it keeps between them, in ISO 15765-2 encoding (see encode_isotp_stmin)
+    uint8_t block_size {0};
+    uint8_t stmin {0};
+
+    // Pad every frame to the full 8 bytes, some ECUs reject shorter frames
+    bool use_padding {false};
+    uint8_t padding_byte {CAN_ISOTP_DEFAULT_PAD_CONTENT};
+
+    bool is_fd {false}; // CAN FD link layer, up to 64 bytes per frame
+};
+
+// Encodes a separation time in microseconds as an ISO 15765-2 STmin byte, rounding up: 0xF1-0xF9 for 100-900 us,
+// 0x01-0x7F for whole milliseconds
+uint8_t encode_isotp_stmin(unsigned int microseconds);
+
+// Parses "TX:RX" hex IDs into options, IDs above 0x7FF are marked extended
+bool parse_isotp_ids(const std::string& text, IsoTpOptions& options);
+
+// Kernel CAN_ISOTP socket. Segmentation, flow control and reassembly happen in the kernel, each send() and
+// receive() moves one complete message.
+class IsoTpSocket
+{
+  public:
+    IsoTpSocket();
+    ~IsoTpSocket();
+
+    IsoTpSocket(const IsoTpSocket&) = delete;
+    IsoTpSocket& operator=(const IsoTpSocket&) = delete;
+
+    int open(const std::string& interface_name, const IsoTpOptions& options);
+    void close();
+
+    // Blocks until the whole message is on the bus
+    ssize_t send(const uint8_t* data, size_t length);
+    ssize_t receive(uint8_t* data, size_t capacity);
+
+    int socket() const;
+
+  private:
+    int m_socket {-1};
+
+    int setup_options(const IsoTpOptions& options);
+};
+
+#endif // ISOTP_SOCKET_H
@@ -0,0 +1,473 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "j1939_socket.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Addresses tried in turn by arbitrary address capable nodes (J1939-81 self-configurable range)
+static constexpr uint8_t ARBITRARY_ADDRESS_FIRST = 128;
+static constexpr uint8_t ARBITRARY_ADDRESS_LAST = 247;
+
+// Time other nodes get to contest a claim before the address is ours
+static constexpr int ADDRESS_CLAIM_TIMEOUT_MS = 250;
+
+bool parse_pgns(const std::string& text, std::vector<pgn_t>& pgns)
+{
+    const char* cursor = text.c_str();
+
+    pgns.clear();
+    while (*cursor != '\0')
+    {
+        char* end;
+        unsigned long pgn = std::strtoul(cursor, &end, 16);
+        if (end == cursor || pgn > J1939_PGN_MAX || (*end != ',' && *end != '\0'))
+        {
+            return false;
+        }
+
+        pgns.push_back(static_cast<pgn_t>(pgn));
+        cursor = *end == ',' ? end + 1 : end;
+    }
+
+    return !pgns.empty();
+}
+
+J1939Socket::J1939Socket() {}
+
+J1939Socket::~J1939Socket()
+{
+    close();
+}
+
+int J1939Socket::open(const std::string& interface_name, const J1939Options& options)
+{
+    m_interface_name = interface_name;
+    m_options = options;
+    m_ifindex = static_cast<int>(if_nametoindex(interface_name.c_str()));
+
+    if (m_ifindex == 0)
+    {
+        perror("Error getting interface index");
+        return 1;
+    }
+
+    if (m_options.name != J1939_NO_NAME)
+    {
+        if (claim_address(m_options.address))
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        m_address = m_options.address;
+    }
+
+    return open_data_socket();
+}
+
+void J1939Socket::close()
+{
+    if (m_socket >= 0)
+    {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+
+    if (m_claim_socket >= 0)
+    {
+        ::close(m_claim_socket);
+        m_claim_socket = -1;
+    }
+}
+
+int J1939Socket::open_data_socket()
+{
+    struct sockaddr_can addr {};
+    int enable = 1;
+    int priority = m_options.priority;
+
+    m_socket = ::socket(PF_CAN, SOCK_DGRAM, CAN_J1939);
+    if (m_socket < 0)
+    {
+        perror("Error opening J1939 socket (is the can-j1939 module loaded?)");
+        return 1;
+    }
+
+    if (!m_options.pgns.empty())
+    {
+        if (m_options.pgns.size() > J1939_FILTER_MAX)
+        {
+            std::cerr << "Error: at most " << J1939_FILTER_MAX << " PGN filters" << std::endl;
+            return 1;
+        }
+
+        // PDU1 PGNs carry no destination in the kernel representation, so the full PGN mask fits both formats
+        std::vector<struct j1939_filter> filters(m_options.pgns.size());
+        for (size_t i = 0; i < filters.size(); i++)
+        {
+            filters[i].pgn = m_options.pgns[i];
+            filters[i].pgn_mask = J1939_PGN_MAX;
+        }
+
+        if (setsockopt(m_socket, SOL_CAN_J1939, SO_J1939_FILTER, filters.data(),
+                       static_cast<socklen_t>(filters.size() * sizeof(struct j1939_filter))) < 0)
+        {
+            perror("Error setting J1939 PGN filters");
+            return 1;
+        }
+    }
+
+    if (m_options.is_promiscuous &&
+        setsockopt(m_socket, SOL_CAN_J1939, SO_J1939_PROMISC, &enable, sizeof(enable)) < 0)
+    {
+        perror("Error enabling J1939 promiscuous mode");
+        return 1;
+    }
+
+    if (setsockopt(m_socket, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable)) < 0 ||
+        setsockopt(m_socket, SOL_CAN_J1939, SO_J1939_SEND_PRIO, &priority, sizeof(priority)) < 0)
+    {
+        perror("Error setting J1939 socket options");
+        return 1;
+    }
+
+    // With a NAME the kernel looks up the claimed address for every message, so it follows a changed claim
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = m_ifindex;
+    addr.can_addr.j1939.name = m_options.name;
+    addr.can_addr.j1939.addr = m_options.name != J1939_NO_NAME ? J1939_NO_ADDR : m_address;
+    addr.can_addr.j1939.pgn = J1939_NO_PGN;
+
+    if (bind(m_socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        perror("Error in J1939 socket bind");
+        return 1;
+    }
+
+    return 0;
+}
+
+int J1939Socket::open_claim_socket(uint8_t address)
+{
+    struct sockaddr_can addr {};
+    struct j1939_filter filters[2] {};
+    int enable = 1;
+
+    if (m_claim_socket >= 0)
+    {
+        ::close(m_claim_socket);
+    }
+
+    m_claim_socket = ::socket(PF_CAN, SOCK_DGRAM, CAN_J1939);
+    if (m_claim_socket < 0)
+    {
+        perror("Error opening J1939 socket (is the can-j1939 module loaded?)");
+        return 1;
+    }
+
+    filters[0].pgn = J1939_PGN_ADDRESS_CLAIMED;
+    filters[0].pgn_mask = J1939_PGN_PDU1_MAX;
+    filters[1].pgn = J1939_PGN_REQUEST;
+    filters[1].pgn_mask = J1939_PGN_PDU1_MAX;
+
+    if (setsockopt(m_claim_socket, SOL_CAN_J1939, SO_J1939_FILTER, filters, sizeof(filters)) < 0 ||
+        setsockopt(m_claim_socket, SOL_CAN_J1939, SO_J1939_PROMISC, &enable, sizeof(enable)) < 0 ||
+        setsockopt(m_claim_socket, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable)) < 0)
+    {
+        perror("Error setting J1939 address claim socket options");
+        return 1;
+    }
+
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = m_ifindex;
+    addr.can_addr.j1939.name = m_options.name;
+    addr.can_addr.j1939.addr = address;
+    addr.can_addr.j1939.pgn = J1939_NO_PGN;
+
+    if (bind(m_claim_socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        perror("Error in J1939 address claim socket bind");
+        return 1;
+    }
+
+    return 0;
+}
+
+int J1939Socket::claim_address(uint8_t first_address)
+{
+    uint8_t candidate = first_address > J1939_MAX_UNICAST_ADDR ? ARBITRARY_ADDRESS_FIRST : first_address;
+    int attempts = is_arbitrary_address_capable() ? ARBITRARY_ADDRESS_LAST - ARBITRARY_ADDRESS_FIRST + 1 : 1;
+
+    for (int attempt = 0; attempt < attempts; attempt++)
+    {
+        if (open_claim_socket(candidate))
+        {
+            return 1;
+        }
+
+        m_address = candidate;
+        send_address_claim();
+
+        if (!wait_for_contention(ADDRESS_CLAIM_TIMEOUT_MS))
+        {
+            std::cout << "Claimed J1939 address 0x" << std::hex << std::uppercase << static_cast<int>(m_address)
+                      << " on " << m_interface_name << std::dec << std::endl;
+            return 0;
+        }
+
+        std::cout << "J1939 address 0x" << std::hex << std::uppercase << static_cast<int>(candidate) << std::dec
+                  << " is taken by a higher priority NAME" << std::endl;
+
+        bool is_in_range = candidate >= ARBITRARY_ADDRESS_FIRST && candidate < ARBITRARY_ADDRESS_LAST;
+        candidate = is_in_range ? candidate + 1 : ARBITRARY_ADDRESS_FIRST;
+    }
+
+    announce_cannot_claim();
+    return 1;
+}
+
+void J1939Socket::announce_cannot_claim()
+{
+    // A claim from the null address tells the network this NAME has no address
+    if (open_claim_socket(J1939_IDLE_ADDR) == 0)
+    {
+        m_address = J1939_IDLE_ADDR;
+        send_address_claim();
+    }
+
+    std::cerr << "Error: could not claim a J1939 address" << std::endl;
+}
+
+void J1939Socket::send_address_claim()
+{
+    struct sockaddr_can destination {};
+    uint8_t data[8];
+
+    // The claim carries the NAME, least significant byte first
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = static_cast<uint8_t>(m_options.name >> (8 * i));
+    }
+
+    destination.can_family = AF_CAN;
+    destination.can_ifindex = m_ifindex;
+    destination.can_addr.j1939.name = J1939_NO_NAME;
+    destination.can_addr.j1939.addr = J1939_NO_ADDR;
+    destination.can_addr.j1939.pgn = J1939_PGN_ADDRESS_CLAIMED;
+
+    if (sendto(m_claim_socket, data, sizeof(data), 0, reinterpret_cast<struct sockaddr*>(&destination),
+               sizeof(destination)) < 0)
+    {
+        perror("Error sending J1939 address claim");
+    }
+}
+
+bool J1939Socket::wait_for_contention(int timeout_ms)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t deadline_ms = static_cast<int64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1'000'000 + timeout_ms;
+
+    while (true)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t remaining_ms = deadline_ms - (static_cast<int64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1'000'000);
+        if (remaining_ms <= 0)
+        {
+            return false;
+        }
+
+        struct pollfd fd {m_claim_socket, POLLIN, 0};
+        if (poll(&fd, 1, static_cast<int>(remaining_ms)) <= 0)
+        {
+            continue;
+        }
+
+        bool is_lost = false;
+        while (handle_claim_message(is_lost))
+        {
+        }
+
+        if (is_lost)
+        {
+            return true;
+        }
+    }
+}
+
+bool J1939Socket::handle_claim_message(bool& is_lost)
+{
+    struct sockaddr_can source {};
+    socklen_t source_length = sizeof(source);
+    uint8_t data[8];
+
+    ssize_t length = recvfrom(m_claim_socket, data, sizeof(data), MSG_DONTWAIT,
+                              reinterpret_cast<struct sockaddr*>(&source), &source_length);
+    if (length < 0)
+    {
+        return false;
+    }
+
+    if (source.can_addr.j1939.pgn == J1939_PGN_REQUEST)
+    {
+        // Everyone answers a request for the address claimed PGN with their current claim
+        pgn_t requested = length >= 3 ? static_cast<pgn_t>(data[0] | data[1] << 8 | data[2] << 16) : J1939_NO_PGN;
+        if (requested == J1939_PGN_ADDRESS_CLAIMED && m_address != J1939_NO_ADDR)
+        {
+            send_address_claim();
+        }
+        return true;
+    }
+
+    if (source.can_addr.j1939.pgn != J1939_PGN_ADDRESS_CLAIMED || length != 8 ||
+        source.can_addr.j1939.addr != m_address)
+    {
+        return true;
+    }
+
+    name_t other_name = 0;
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        other_name |= static_cast<name_t>(data[i]) << (8 * i);
+    }
+
+    // The lower NAME has the higher priority and keeps the address, the other node has to move
+    if (other_name < m_options.name)
+    {
+        is_lost = true;
+    }
+    else if (other_name > m_options.name)
+    {
+        send_address_claim();
+    }
+
+    return true;
+}
+
+void J1939Socket::service_claims()
+{
+    bool is_lost = false;
+    while (handle_claim_message(is_lost))
+    {
+    }
+
+    if (!is_lost)
+    {
+        return;
+    }
+
+    std::cout << "Warning: J1939 address 0x" << std::hex << std::uppercase << static_cast<int>(m_address) << std::dec
+              << " was claimed by a higher priority NAME" << std::endl;
+
+    if (!is_arbitrary_address_capable())
+    {
+        announce_cannot_claim();
+        return;
+    }
+
+    bool is_in_range = m_address >= ARBITRARY_ADDRESS_FIRST && m_address < ARBITRARY_ADDRESS_LAST;
+    claim_address(is_in_range ? m_address + 1 : ARBITRARY_ADDRESS_FIRST);
+}
+
+bool J1939Socket::is_arbitrary_address_capable() const
+{
+    return (m_options.name >> 63) & 1;
+}
+
+ssize_t J1939Socket::receive(uint8_t* data, size_t capacity, J1939Message& message, int flags)
+{
+    struct sockaddr_can source {};
+    struct iovec iov {data, capacity};
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(uint8_t)) * 2 + CMSG_SPACE(sizeof(name_t))];
+    struct msghdr header {};
+
+    header.msg_name = &source;
+    header.msg_namelen = sizeof(source);
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+
+    ssize_t length = recvmsg(m_socket, &header, flags);
+    if (length < 0)
+    {
+        return length;
+    }
+
+    message.pgn = source.can_addr.j1939.pgn;
+    message.source_address = source.can_addr.j1939.addr;
+    message.source_name = source.can_addr.j1939.name;
+    message.destination_address = J1939_NO_ADDR; // Broadcast messages carry no destination
+    message.priority = 0;
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr; cmsg = CMSG_NXTHDR(&header, cmsg))
+    {
+        if (cmsg->cmsg_level != SOL_CAN_J1939)
+        {
+            continue;
+        }
+
+        if (cmsg->cmsg_type == SCM_J1939_DEST_ADDR)
+        {
+            message.destination_address = *CMSG_DATA(cmsg);
+        }
+        else if (cmsg->cmsg_type == SCM_J1939_PRIO)
+        {
+            message.priority = *CMSG_DATA(cmsg);
+        }
+    }
+
+    return length;
+}
+
+ssize_t J1939Socket::send(pgn_t pgn, uint8_t destination, const uint8_t* data, size_t length)
+{
+    struct sockaddr_can addr {};
+
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = m_ifindex;
+    addr.can_addr.j1939.name = J1939_NO_NAME;
+    addr.can_addr.j1939.addr = destination;
+    addr.can_addr.j1939.pgn = pgn;
+
+    return sendto(m_socket, data, length, 0, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+}
+
+int J1939Socket::socket() const
+{
+    return m_socket;
+}
+
+int J1939Socket::claim_socket() const
+{
+    return m_claim_socket;
+}
+
+uint8_t J1939Socket::address() const
+{
+    return m_address;
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef J1939_SOCKET_H
+#define J1939_SOCKET_H
+
+#include <linux/can.h>
+#include <linux/can/j1939.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// Largest message of the J1939-21 transport protocol, 255 packets of 7 bytes
+constexpr size_t J1939_MAX_PAYLOAD = 1785;
+
+struct J1939Options
+{
+    // NAME to claim an address with (J1939-81). J1939_NO_NAME skips address claiming and uses address as is.
+    name_t name {J1939_NO_NAME};
+
+    // Preferred address when claiming, otherwise the static source address. J1939_NO_ADDR only listens.
+    uint8_t address {J1939_NO_ADDR};
+
+    std::vector<pgn_t> pgns {};  // Only receive these PGNs, all when empty
+    bool is_promiscuous {false}; // Also receive messages addressed to other nodes
+    uint8_t priority {6};        // Priority of sent messages, 0 is the highest
+};
+
+// Source, destination and PGN of one received message
+struct J1939Message
+{
+    pgn_t pgn;
+    uint8_t source_address;
+    uint8_t destination_address;
+    name_t source_name;
+    uint8_t priority;
+};
+
+// Parses a comma separated list of hex PGNs
+bool parse_pgns(const std::string& text, std::vector<pgn_t>& pgns);
+
+// Kernel CAN_J1939 socket. The kernel reassembles transport protocol (TP and BAM) sessions, so one receive()
+// returns a whole message of up to J1939_MAX_PAYLOAD bytes. Address claiming runs on a second socket that only
+// sees claim and request traffic, service_claims() answers it while the application runs.
+class J1939Socket
+{
+  public:
+    J1939Socket();
+    ~J1939Socket();
+
+    J1939Socket(const J1939Socket&) = delete;
+    J1939Socket& operator=(const J1939Socket&) = delete;
+
+    int open(const std::string& interface_name, const J1939Options& options);
+    void close();
+
+    ssize_t receive(uint8_t* data, size_t capacity, J1939Message& message, int flags = 0);
+    ssize_t send(pgn_t pgn, uint8_t destination, const uint8_t* data, size_t length);
+
+    // Handles pending claim and request messages, call when claim_socket() is readable
+    void service_claims();
+
+    int socket() const;
+    int claim_socket() const;
+    uint8_t address() const;
+
+  private:
+    std::string m_interface_name {};
+    int m_ifindex {0};
+    J1939Options m_options {};
+    int m_socket {-1};
+    int m_claim_socket {-1};
+    uint8_t m_address {J1939_NO_ADDR};
+
+    int open_data_socket();
+    int open_claim_socket(uint8_t address);
+    int claim_address(uint8_t first_address);
+    void announce_cannot_claim();
+    void send_address_claim();
+    bool handle_claim_message(bool& is_lost);
+    bool wait_for_contention(int timeout_ms);
+    bool is_arbitrary_address_capable() const;
+};
+
+#endif // J1939_SOCKET_H
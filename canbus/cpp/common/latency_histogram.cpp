@@ -0,0 +1,123 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+
+void LatencyHistogram::add(uint64_t ns)
+{
+    m_count++;
+    m_max_ns = std::max(m_max_ns, ns);
+    m_buckets[bucket_of(ns)]++;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * m_count)));
+    uint64_t seen = 0;
+
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; bucket++)
+    {
+        seen += m_buckets[bucket];
+        if (seen >= target)
+        {
+            return std::min(bucket_value(bucket), m_max_ns);
+        }
+    }
+
+    return m_max_ns;
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return m_count;
+}
+
+uint64_t LatencyHistogram::max() const
+{
+    return m_max_ns;
+}
+
+void LatencyHistogram::print_percentiles(std::ostream& out) const
+{
+    if (m_count == 0)
+    {
+        return;
+    }
+
+    const std::array<std::pair<const char*, double>, 4> percentiles {
+        {{"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}, {"p99.9", 0.999}}};
+    for (const auto& [label, fraction] : percentiles)
+    {
+        out << " " << label << "=";
+        print_duration(out, percentile(fraction));
+    }
+    out << " max=";
+    print_duration(out, m_max_ns);
+}
+
+
+// Values below 16 ns have a bucket each, above the top 5 bits select it: exponent, then 4 bits below the top one
+size_t LatencyHistogram::bucket_of(uint64_t ns)
+{
+    ns = std::min<uint64_t>(ns, (2ULL << MAX_EXPONENT) - 1);
+    if (ns < (1U << SUB_BUCKET_BITS))
+    {
+        return ns;
+    }
+
+    unsigned int exponent = 63 - static_cast<unsigned int>(__builtin_clzll(ns));
+    size_t sub_bucket = (ns >> (exponent - SUB_BUCKET_BITS)) & ((1U << SUB_BUCKET_BITS) - 1);
+    return ((exponent - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + sub_bucket;
+}
+
+// Middle of the bucket's range
+uint64_t LatencyHistogram::bucket_value(size_t bucket)
+{
+    if (bucket < (1U << SUB_BUCKET_BITS))
+    {
+        return bucket;
+    }
+
+    unsigned int exponent = static_cast<unsigned int>(bucket >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+    uint64_t sub_bucket = bucket & ((1U << SUB_BUCKET_BITS) - 1);
+    uint64_t width = 1ULL << (exponent - SUB_BUCKET_BITS);
+    return (((1ULL << SUB_BUCKET_BITS) + sub_bucket) << (exponent - SUB_BUCKET_BITS)) + width / 2;
+}
+
+void print_duration(std::ostream& out, uint64_t ns)
+{
+    char text[32];
+
+    if (ns < 1'000'000)
+    {
+        std::snprintf(text, sizeof(text), "%.1fus", ns / 1e3);
+    }
+    else if (ns < 1'000'000'000)
+    {
+        std::snprintf(text, sizeof(text), "%.1fms", ns / 1e6);
+    }
+    else
+    {
+        std::snprintf(text, sizeof(text), "%.1fs", ns / 1e9);
+    }
+
+    out << text;
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Log-linear latency histogram, 16 buckets per power of two nanoseconds, so percentiles are within 3%
+class LatencyHistogram
+{
+  public:
+    static constexpr unsigned int SUB_BUCKET_BITS = 4;
+    static constexpr unsigned int MAX_EXPONENT = 40; // Latencies up to 2^41 ns, about 37 minutes
+    static constexpr size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) << SUB_BUCKET_BITS;
+
+    void add(uint64_t ns);
+    uint64_t percentile(double fraction) const;
+    uint64_t count() const;
+    uint64_t max() const;
+
+    // Prints " p50=... p90=... p99=... p99.9=... max=...", nothing while the histogram is empty
+    void print_percentiles(std::ostream& out) const;
+
+  private:
+    uint64_t m_count {0};
+    uint64_t m_max_ns {0};
+    std::array<uint32_t, BUCKET_COUNT> m_buckets {};
+
+    static size_t bucket_of(uint64_t ns);
+    static uint64_t bucket_value(size_t bucket);
+};
+
+// Prints ns in us, ms or s with one decimal, as a single field so a preceding std::setw() pads all of it
+void print_duration(std::ostream& out, uint64_t ns);
+
+#endif // LATENCY_HISTOGRAM_H
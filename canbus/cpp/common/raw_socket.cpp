@@ -0,0 +1,65 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "raw_socket.h"
+#include <cstring>
+#include <poll.h>
+#include <time.h>
+
+void read_control_messages(const struct msghdr& message, ReceivedFrame& received, uint32_t& drop_counter)
+{
+    for (const struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(const_cast<struct msghdr*>(&message), const_cast<struct cmsghdr*>(cmsg)))
+    {
+        if (cmsg->cmsg_level != SOL_SOCKET)
+        {
+            continue;
+        }
+
+        // Only present once the queue has dropped something
+        if (cmsg->cmsg_type == SO_RXQ_OVFL)
+        {
+            std::memcpy(&drop_counter, CMSG_DATA(cmsg), sizeof(drop_counter));
+            continue;
+        }
+
+        if (cmsg->cmsg_type != SO_TIMESTAMPING)
+        {
+            continue;
+        }
+
+        // ts[0] is the software timestamp, ts[2] the raw hardware one
+        struct scm_timestamping timestamps;
+        std::memcpy(&timestamps, CMSG_DATA(cmsg), sizeof(timestamps));
+
+        received.is_hw_timestamp = timestamps.ts[2].tv_sec != 0 || timestamps.ts[2].tv_nsec != 0;
+        received.timestamp = received.is_hw_timestamp ? timestamps.ts[2] : timestamps.ts[0];
+    }
+}
+
+void wait_for_tx_queue(int socket)
+{
+    // The TX queue is full, wait for the driver to drain it instead of failing
+    struct pollfd pfd {socket, POLLOUT, 0};
+    if (poll(&pfd, 1, 100) > 0)
+    {
+        // POLLOUT only tracks the socket buffer, back off briefly in case the device queue is still full
+        struct timespec backoff {0, 50'000};
+        nanosleep(&backoff, nullptr);
+    }
+}
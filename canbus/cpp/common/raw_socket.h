@@ -0,0 +1,40 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef RAW_SOCKET_H
+#define RAW_SOCKET_H
+
+#include "received_frame.h"
+#include <linux/errqueue.h>
+#include <cstdint>
+#include <sys/socket.h>
+
+// Control message space of one recvmmsg() slot: timestamps and the SO_RXQ_OVFL drop counter
+struct ControlBuffer
+{
+    alignas(struct cmsghdr) char data[CMSG_SPACE(sizeof(struct scm_timestamping)) + CMSG_SPACE(sizeof(uint32_t))];
+};
+
+// Reads the timestamp of a received frame, the hardware one when the controller set it, and the socket's
+// SO_RXQ_OVFL total into drop_counter. drop_counter is left unchanged until the queue has dropped something.
+void read_control_messages(const struct msghdr& message, ReceivedFrame& received, uint32_t& drop_counter);
+
+// Waits for the driver to drain a full TX queue, after a send failed with ENOBUFS or EAGAIN
+void wait_for_tx_queue(int socket);
+
+#endif // RAW_SOCKET_H
@@ -0,0 +1,214 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "realtime.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Stack the time critical threads may use without faulting once prefaulted
+static constexpr size_t PREFAULT_STACK_SIZE = 256 * 1024;
+
+bool parse_scheduling(const char* text, RealtimeOptions& options)
+{
+    const char* separator = std::strchr(text, ':');
+    std::string name = separator ? std::string(text, static_cast<size_t>(separator - text)) : std::string(text);
+
+    if (name == "other")
+    {
+        options.policy = SCHED_OTHER;
+        options.priority = 0;
+        return separator == nullptr;
+    }
+
+    if (name == "fifo")
+    {
+        options.policy = SCHED_FIFO;
+    }
+    else if (name == "rr")
+    {
+        options.policy = SCHED_RR;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (separator == nullptr)
+    {
+        return false;
+    }
+
+    char* end;
+    long priority = std::strtol(separator + 1, &end, 10);
+    if (*end != '\0' || end == separator + 1 || priority < sched_get_priority_min(options.policy) ||
+        priority > sched_get_priority_max(options.policy))
+    {
+        return false;
+    }
+
+    options.priority = static_cast<int>(priority);
+    return true;
+}
+
+bool parse_cpu_list(const char* text, std::vector<int>& cpus)
+{
+    std::vector<int> parsed;
+    const char* cursor = text;
+
+    while (true)
+    {
+        char* end;
+        long first = std::strtol(cursor, &end, 10);
+        if (end == cursor || first < 0 || first >= CPU_SETSIZE)
+        {
+            return false;
+        }
+
+        long last = first;
+        if (*end == '-')
+        {
+            cursor = end + 1;
+            last = std::strtol(cursor, &end, 10);
+            if (end == cursor || last < first || last >= CPU_SETSIZE)
+            {
+                return false;
+            }
+        }
+
+        for (long cpu = first; cpu <= last; cpu++)
+        {
+            parsed.push_back(static_cast<int>(cpu));
+        }
+
+        if (*end == '\0')
+        {
+            break;
+        }
+        if (*end != ',')
+        {
+            return false;
+        }
+        cursor = end + 1;
+    }
+
+    cpus = std::move(parsed);
+    return true;
+}
+
+void lock_memory()
+{
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        std::cout << "Warning: mlockall failed (" << std::strerror(errno) << ") - may affect RT performance"
+                  << std::endl;
+        return;
+    }
+
+    std::cout << "Memory locked" << std::endl;
+}
+
+void prefault(void* data, size_t size)
+{
+    if (data == nullptr || size == 0)
+    {
+        return;
+    }
+
+    // Read and write back one byte per page, which faults the page in without changing its content
+    volatile char* bytes = static_cast<volatile char*>(data);
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    for (size_t offset = 0; offset < size; offset += page_size)
+    {
+        bytes[offset] = bytes[offset];
+    }
+    bytes[size - 1] = bytes[size - 1];
+}
+
+static void __attribute__((noinline)) prefault_stack()
+{
+    volatile char stack[PREFAULT_STACK_SIZE];
+    for (size_t offset = 0; offset < sizeof(stack); offset += 4096)
+    {
+        stack[offset] = 0;
+    }
+}
+
+int apply_realtime(const RealtimeOptions& options, size_t index, const char* thread_name)
+{
+    int result = 0;
+    pthread_t thread = pthread_self();
+
+    if (!options.cpus.empty())
+    {
+        int cpu = options.cpus[std::min(index, options.cpus.size() - 1)];
+
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+
+        int ret = pthread_setaffinity_np(thread, sizeof(cpu_set), &cpu_set);
+        if (ret != 0)
+        {
+            std::cerr << "Error setting " << thread_name << " thread affinity to CPU " << cpu << ": "
+                      << std::strerror(ret) << std::endl;
+            result = 1;
+        }
+        else
+        {
+            std::cout << "Pinned " << thread_name << " thread to CPU " << cpu << std::endl;
+        }
+    }
+
+    if (options.policy != SCHED_OTHER)
+    {
+        struct sched_param param {};
+        param.sched_priority = options.priority;
+
+        int ret = pthread_setschedparam(thread, options.policy, &param);
+        if (ret != 0)
+        {
+            std::cerr << "Error setting " << thread_name << " thread scheduling: " << std::strerror(ret) << std::endl;
+            if (ret == EPERM)
+            {
+                std::cerr << "Real-time scheduling needs root or CAP_SYS_NICE" << std::endl;
+                std::cerr << "Try: sudo setcap cap_sys_nice,cap_ipc_lock=eip <program>" << std::endl;
+            }
+            result = 1;
+        }
+        else
+        {
+            std::cout << "Running " << thread_name << " thread with "
+                      << (options.policy == SCHED_FIFO ? "SCHED_FIFO" : "SCHED_RR") << " priority " << options.priority
+                      << std::endl;
+        }
+    }
+
+    if (options.lock_memory)
+    {
+        prefault_stack();
+    }
+
+    return result;
+}
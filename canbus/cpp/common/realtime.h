@@ -0,0 +1,56 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <cstddef>
+#include <sched.h>
+#include <string>
+#include <vector>
+
+// Scheduling of the threads that touch the socket, for bounded latency on PREEMPT_RT kernels
+struct RealtimeOptions
+{
+    int policy {SCHED_OTHER}; // SCHED_FIFO or SCHED_RR make the threads real-time
+    int priority {0};         // 1 to 99 for the real-time policies
+    std::vector<int> cpus {}; // CPU of each thread in order, the last one is reused, empty keeps the default
+    bool lock_memory {false}; // mlockall() and prefault the buffers so no page fault happens while receiving
+
+    bool is_enabled() const
+    {
+        return policy != SCHED_OTHER || !cpus.empty() || lock_memory;
+    }
+};
+
+// Parses "fifo:80", "rr:50" or "other" into policy and priority. Returns false for malformed values.
+bool parse_scheduling(const char* text, RealtimeOptions& options);
+
+// Parses a CPU list like "2" or "1,3-4". Returns false for malformed values.
+bool parse_cpu_list(const char* text, std::vector<int>& cpus);
+
+// Locks current and future pages of the process into memory, warns when not permitted
+void lock_memory();
+
+// Writes to every page of a buffer so it is backed before the time critical code first touches it
+void prefault(void* data, size_t size);
+
+// Applies options to the calling thread, index selects its CPU. Prints what was applied, warns about what was not
+// permitted and returns 1 when the thread keeps its default scheduling.
+int apply_realtime(const RealtimeOptions& options, size_t index, const char* thread_name);
+
+#endif // REALTIME_H
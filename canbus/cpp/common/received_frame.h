@@ -0,0 +1,33 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef RECEIVED_FRAME_H
+#define RECEIVED_FRAME_H
+
+#include <linux/can.h>
+#include <time.h>
+
+struct ReceivedFrame
+{
+    canfd_frame frame;
+    bool is_fd;
+    struct timespec timestamp; // Kernel arrival time, zero when the socket delivered none
+    bool is_hw_timestamp;      // Timestamp comes from the controller rather than the network stack
+    int ifindex;               // Interface the frame arrived on
+};
+
+#endif // RECEIVED_FRAME_H
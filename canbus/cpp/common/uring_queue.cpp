@@ -0,0 +1,287 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "uring_queue.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int io_uring_setup(unsigned int entries, struct io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int io_uring_register(int fd, unsigned int opcode, void* arg, unsigned int count)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+UringQueue::UringQueue() {}
+
+UringQueue::~UringQueue()
+{
+    close();
+}
+
+int UringQueue::open(unsigned int entries)
+{
+    // Deferring task work to the next io_uring_enter() saves interrupting the thread, it always enters to wait
+    struct io_uring_params params {};
+    params.flags = IORING_SETUP_COOP_TASKRUN;
+
+    m_fd = io_uring_setup(entries, &params);
+    if (m_fd < 0 && errno == EINVAL)
+    {
+        // Before Linux 5.19
+        params = {};
+        m_fd = io_uring_setup(entries, &params);
+    }
+
+    if (m_fd < 0)
+    {
+        perror("Error creating io_uring");
+        return 1;
+    }
+
+    m_sq_mapping_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    m_cq_mapping_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    // Since Linux 5.4 both rings live in one mapping
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        m_sq_mapping_size = std::max(m_sq_mapping_size, m_cq_mapping_size);
+    }
+
+    m_sq_mapping = mmap(nullptr, m_sq_mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+                        IORING_OFF_SQ_RING);
+    if (m_sq_mapping == MAP_FAILED)
+    {
+        m_sq_mapping = nullptr;
+        perror("Error mapping io_uring submission queue");
+        close();
+        return 1;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        m_cq_mapping = m_sq_mapping;
+    }
+    else
+    {
+        m_cq_mapping = mmap(nullptr, m_cq_mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+                            IORING_OFF_CQ_RING);
+        if (m_cq_mapping == MAP_FAILED)
+        {
+            m_cq_mapping = nullptr;
+            perror("Error mapping io_uring completion queue");
+            close();
+            return 1;
+        }
+    }
+
+    m_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        perror("Error mapping io_uring submission entries");
+        close();
+        return 1;
+    }
+    m_sqes = static_cast<struct io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(m_sq_mapping);
+    m_sq_head = reinterpret_cast<unsigned int*>(sq + params.sq_off.head);
+    m_sq_tail = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+    m_sq_mask = *reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+    m_sq_entries = params.sq_entries;
+    m_sqe_tail = *m_sq_tail;
+    m_pending_count = 0;
+
+    // Submission entry i always sits in slot i, so the index array is filled once
+    unsigned int* sq_array = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+    for (unsigned int i = 0; i < m_sq_entries; i++)
+    {
+        sq_array[i] = i;
+    }
+
+    char* cq = static_cast<char*>(m_cq_mapping);
+    m_cq_head = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+    m_cq_tail = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+    m_cq_mask = *reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    return 0;
+}
+
+void UringQueue::close()
+{
+    if (m_buffer_ring)
+    {
+        munmap(m_buffer_ring, m_buffer_ring_size);
+        m_buffer_ring = nullptr;
+    }
+
+    if (m_buffers)
+    {
+        munmap(m_buffers, m_buffers_size);
+        m_buffers = nullptr;
+    }
+
+    if (m_sqes)
+    {
+        munmap(m_sqes, m_sqes_size);
+        m_sqes = nullptr;
+    }
+
+    if (m_cq_mapping && m_cq_mapping != m_sq_mapping)
+    {
+        munmap(m_cq_mapping, m_cq_mapping_size);
+    }
+    m_cq_mapping = nullptr;
+
+    if (m_sq_mapping)
+    {
+        munmap(m_sq_mapping, m_sq_mapping_size);
+        m_sq_mapping = nullptr;
+    }
+
+    // Closing the ring cancels whatever requests are still in flight
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool UringQueue::is_open() const
+{
+    return m_fd >= 0;
+}
+
+struct io_uring_sqe* UringQueue::get_sqe()
+{
+    unsigned int head = __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+    if (m_sqe_tail - head >= m_sq_entries)
+    {
+        return nullptr;
+    }
+
+    struct io_uring_sqe* sqe = &m_sqes[m_sqe_tail & m_sq_mask];
+    std::memset(sqe, 0, sizeof(*sqe));
+    m_sqe_tail++;
+
+    return sqe;
+}
+
+int UringQueue::submit(unsigned int wait_count)
+{
+    unsigned int tail = *m_sq_tail;
+    if (tail != m_sqe_tail)
+    {
+        m_pending_count += m_sqe_tail - tail;
+        __atomic_store_n(m_sq_tail, m_sqe_tail, __ATOMIC_RELEASE);
+    }
+
+    int submitted = io_uring_enter(m_fd, m_pending_count, wait_count, wait_count > 0 ? IORING_ENTER_GETEVENTS : 0);
+    if (submitted < 0)
+    {
+        return -1;
+    }
+
+    m_pending_count -= static_cast<unsigned int>(submitted);
+
+    return submitted;
+}
+
+int UringQueue::setup_buffers(uint16_t group, unsigned int count, unsigned int size)
+{
+    if (count == 0 || count > 32768 || (count & (count - 1)) != 0)
+    {
+        errno = EINVAL;
+        return 1;
+    }
+
+    m_buffer_ring_size = count * sizeof(struct io_uring_buf);
+    void* ring = mmap(nullptr, m_buffer_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE,
+                      -1, 0);
+    if (ring == MAP_FAILED)
+    {
+        return 1;
+    }
+    m_buffer_ring = static_cast<struct io_uring_buf_ring*>(ring);
+
+    struct io_uring_buf_reg registration {};
+    registration.ring_addr = reinterpret_cast<uint64_t>(m_buffer_ring);
+    registration.ring_entries = count;
+    registration.bgid = group;
+
+    if (io_uring_register(m_fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+    {
+        int error = errno;
+        munmap(m_buffer_ring, m_buffer_ring_size);
+        m_buffer_ring = nullptr;
+        errno = error;
+        return 1;
+    }
+
+    m_buffers_size = static_cast<size_t>(count) * size;
+    void* buffers = mmap(nullptr, m_buffers_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE,
+                         -1, 0);
+    if (buffers == MAP_FAILED)
+    {
+        m_buffers = nullptr;
+        return 1;
+    }
+    m_buffers = static_cast<uint8_t*>(buffers);
+
+    m_buffer_size = size;
+    m_buffer_mask = count - 1;
+    m_buffer_tail = 0;
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        recycle_buffer(static_cast<uint16_t>(i));
+    }
+
+    return 0;
+}
+
+uint8_t* UringQueue::buffer(uint16_t id) const
+{
+    return m_buffers + static_cast<size_t>(id) * m_buffer_size;
+}
+
+void UringQueue::recycle_buffer(uint16_t id)
+{
+    // Indexed through a plain pointer, the header's flexible array member is shifted by 8 bytes when compiled as C++
+    struct io_uring_buf& entry = reinterpret_cast<struct io_uring_buf*>(m_buffer_ring)[m_buffer_tail & m_buffer_mask];
+    entry.addr = reinterpret_cast<uint64_t>(buffer(id));
+    entry.len = m_buffer_size;
+    entry.bid = id;
+
+    m_buffer_tail++;
+    __atomic_store_n(&m_buffer_ring->tail, m_buffer_tail, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef URING_QUEUE_H
+#define URING_QUEUE_H
+
+#include <linux/io_uring.h>
+#include <cstddef>
+#include <cstdint>
+
+// Submission and completion queues of one io_uring instance, set up with the raw system calls so no liburing is
+// needed. Used from a single thread: get_sqe() fills requests, submit() hands them to the kernel and optionally
+// waits, drain() walks the completions. A ring of provided buffers lets multishot receives pick their own buffer.
+class UringQueue
+{
+  public:
+    UringQueue();
+    ~UringQueue();
+
+    UringQueue(const UringQueue&) = delete;
+    UringQueue& operator=(const UringQueue&) = delete;
+
+    int open(unsigned int entries);
+    void close();
+    bool is_open() const;
+
+    // Next free submission entry, zeroed, or nullptr when the queue is full until the next submit()
+    struct io_uring_sqe* get_sqe();
+
+    // Submits the filled entries and waits for at least wait_count completions. Returns the number of entries
+    // submitted, or -1 with errno set (EINTR when a signal arrived while waiting).
+    int submit(unsigned int wait_count = 0);
+
+    // Calls handler(cqe) for every completion available and returns their number
+    template <typename Handler>
+    unsigned int drain(Handler&& handler);
+
+    // Registers count buffers of size bytes each as buffer group, count must be a power of two. Fails with
+    // EINVAL on kernels before 5.19, which have no buffer rings.
+    int setup_buffers(uint16_t group, unsigned int count, unsigned int size);
+    uint8_t* buffer(uint16_t id) const;
+    void recycle_buffer(uint16_t id); // Hands a buffer taken by a completion back to the kernel
+
+  private:
+    int m_fd {-1};
+    void* m_sq_mapping {nullptr};
+    size_t m_sq_mapping_size {0};
+    void* m_cq_mapping {nullptr};
+    size_t m_cq_mapping_size {0};
+    struct io_uring_sqe* m_sqes {nullptr};
+    size_t m_sqes_size {0};
+
+    unsigned int* m_sq_head {nullptr};
+    unsigned int* m_sq_tail {nullptr};
+    unsigned int m_sq_mask {0};
+    unsigned int m_sq_entries {0};
+    unsigned int m_sqe_tail {0};      // Entries handed out by get_sqe(), published to m_sq_tail by submit()
+    unsigned int m_pending_count {0}; // Published entries the kernel has not consumed yet
+
+    unsigned int* m_cq_head {nullptr};
+    unsigned int* m_cq_tail {nullptr};
+    unsigned int m_cq_mask {0};
+    struct io_uring_cqe* m_cqes {nullptr};
+
+    struct io_uring_buf_ring* m_buffer_ring {nullptr};
+    size_t m_buffer_ring_size {0};
+    uint8_t* m_buffers {nullptr};
+    size_t m_buffers_size {0};
+    unsigned int m_buffer_size {0};
+    unsigned int m_buffer_mask {0};
+    uint16_t m_buffer_tail {0};
+};
+
+template <typename Handler>
+unsigned int UringQueue::drain(Handler&& handler)
+{
+    unsigned int head = *m_cq_head;
+    unsigned int tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+    unsigned int count = tail - head;
+
+    for (; head != tail; head++)
+    {
+        handler(m_cqes[head & m_cq_mask]);
+    }
+
+    // Release the entries only after the handler is done with them
+    __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+
+    return count;
+}
+
+#endif // URING_QUEUE_H
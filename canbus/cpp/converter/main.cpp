@@ -0,0 +1,273 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "can_capture.h"
+#include "candump_format.h"
+#include "frame_datagram.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <iostream>
+#include <string>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+static volatile sig_atomic_t g_is_running = 1;
+
+void signal_handler([[maybe_unused]] int sig)
+{
+    g_is_running = 0;
+}
+
+void print_usage(std::string_view program_name)
+{
+    std::cout << "Usage: " << program_name << " [OPTIONS] CAPTURE" << std::endl;
+    std::cout << "       " << program_name << " [OPTIONS] -u [HOST:]PORT|-x PATH" << std::endl;
+    std::cout << "Converts a binary capture written by canbus-receiver --write, or the datagrams of canbus-gateway in"
+              << std::endl;
+    std::cout << "bridge mode until Ctrl+C, to candump -l text format." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  CAPTURE               Binary capture file" << std::endl;
+    std::cout << "  -u, --udp [HOST:]PORT Decode bridge datagrams received on a UDP port" << std::endl;
+    std::cout << "  -x, --unix PATH       Decode bridge datagrams received on a Unix socket, @NAME for abstract"
+              << std::endl;
+    std::cout << "  -o, --output FILE     Write to FILE instead of stdout" << std::endl;
+    std::cout << "  -i, --interface NAME  Interface name to print instead of the captured one" << std::endl;
+    std::cout << "  -h, --help            Show this help message" << std::endl;
+    std::cout << std::endl << "Example: " << program_name << " -o vcan0.log vcan0.cap" << std::endl;
+    std::cout << "         " << program_name << " -u 127.0.0.1:5000 -o bridge.log" << std::endl;
+}
+
+int decode_datagrams(const DatagramEndpoint& endpoint, FILE* output, const std::string& interface_override)
+{
+    int datagram_socket = open_datagram_socket(endpoint, true);
+    if (datagram_socket < 0)
+    {
+        return 1;
+    }
+
+    std::cerr << "Decoding bridge datagrams on " << (endpoint.is_unix ? "unix " : "udp ") << endpoint.address
+              << ", press Ctrl+C to stop" << std::endl;
+
+    std::vector<uint8_t> buffer(DATAGRAM_MAX_SIZE);
+    DatagramDecoder decoder {};
+    char line[CANDUMP_LINE_MAX];
+    uint64_t frame_count = 0;
+    uint64_t datagram_count = 0;
+    uint64_t byte_count = 0;
+    uint64_t lost_count = 0;
+    uint64_t invalid_count = 0;
+    uint32_t next_sequence = 0;
+    struct timespec start {};
+    struct timespec end {};
+
+    while (g_is_running)
+    {
+        ssize_t size = recv(datagram_socket, buffer.data(), buffer.size(), 0);
+        if (size < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            perror("Error receiving datagram");
+            break;
+        }
+
+        if (!decoder.open(buffer.data(), static_cast<size_t>(size)))
+        {
+            invalid_count++;
+            continue;
+        }
+
+        // Gaps in the sequence are lost datagrams, a sequence going back means the bridge was restarted
+        if (datagram_count == 0)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+        }
+        else if (static_cast<int32_t>(decoder.sequence() - next_sequence) > 0)
+        {
+            lost_count += decoder.sequence() - next_sequence;
+        }
+        next_sequence = decoder.sequence() + 1;
+        datagram_count++;
+        byte_count += static_cast<uint64_t>(size);
+
+        const char* interface_name = interface_override.empty() ? decoder.interface_name() : interface_override.c_str();
+        if (interface_name[0] == '\0')
+        {
+            interface_name = "unknown";
+        }
+
+        CaptureRecord record;
+        while (decoder.next(record))
+        {
+            std::fwrite(line, 1, format_candump_line(record, interface_name, line), output);
+            frame_count++;
+        }
+        std::fflush(output);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+    }
+
+    close(datagram_socket);
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    std::cerr << "Decoded " << frame_count << " frame(s) from " << datagram_count << " datagram(s) in " << elapsed
+              << " s (" << (elapsed > 0 ? frame_count / elapsed : 0.0) << " frames/s)";
+    if (datagram_count > 0)
+    {
+        std::cerr << ", " << static_cast<double>(frame_count) / datagram_count << " frames and "
+                  << static_cast<double>(byte_count) / datagram_count << " bytes per datagram";
+    }
+    std::cerr << ", lost " << lost_count << ", invalid " << invalid_count << std::endl;
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string output_path;
+    std::string interface_override;
+    DatagramEndpoint endpoint {false, {}};
+    bool is_decoding = false;
+    int opt;
+    static struct option long_options[] = {{"udp", required_argument, 0, 'u'},
+                                           {"unix", required_argument, 0, 'x'},
+                                           {"output", required_argument, 0, 'o'},
+                                           {"interface", required_argument, 0, 'i'},
+                                           {"help", no_argument, 0, 'h'},
+                                           {0, 0, 0, 0}};
+
+    while ((opt = getopt_long(argc, argv, "u:x:o:i:h", long_options, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+        case 'u':
+        case 'x':
+            endpoint = {opt == 'x', optarg};
+            is_decoding = true;
+            break;
+        case 'o':
+            output_path = optarg;
+            break;
+        case 'i':
+            if (std::strlen(optarg) >= IFNAMSIZ)
+            {
+                std::cerr << "Invalid interface name, at most " << IFNAMSIZ - 1 << " characters: " << optarg
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+            interface_override = optarg;
+            break;
+        case 'h':
+            print_usage(argv[0]);
+            return EXIT_SUCCESS;
+        default:
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc && !is_decoding)
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (optind < argc && is_decoding)
+    {
+        std::cerr << "A capture file cannot be converted while decoding datagrams: " << argv[optind] << std::endl;
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    CaptureReader reader {};
+    if (!is_decoding && reader.open(argv[optind]))
+    {
+        return EXIT_FAILURE;
+    }
+
+    FILE* output = stdout;
+    if (!output_path.empty())
+    {
+        output = std::fopen(output_path.c_str(), "w");
+        if (output == nullptr)
+        {
+            perror("Error opening output file");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Large stdio buffer, a capture can hold millions of lines. Static because stdout still owns it at exit.
+    static char buffer[1 << 20];
+    std::setvbuf(output, buffer, _IOFBF, sizeof(buffer));
+
+    if (is_decoding)
+    {
+        // Install without SA_RESTART so a blocking receive returns EINTR and the decoder can stop cleanly
+        struct sigaction action {};
+        action.sa_handler = signal_handler;
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+
+        int result = decode_datagrams(endpoint, output, interface_override);
+        if (output != stdout)
+        {
+            std::fclose(output);
+        }
+        return result ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    char line[CANDUMP_LINE_MAX];
+    for (uint64_t i = 0; i < reader.record_count(); i++)
+    {
+        const CaptureRecord& record = reader.record(i);
+        const char* interface_name = reader.interface_name(record.ifindex);
+
+        if (!interface_override.empty())
+        {
+            interface_name = interface_override.c_str();
+        }
+        else if (interface_name == nullptr)
+        {
+            interface_name = "unknown";
+        }
+
+        std::fwrite(line, 1, format_candump_line(record, interface_name, line), output);
+    }
+
+    if (std::fflush(output) != 0)
+    {
+        perror("Error writing output");
+        return EXIT_FAILURE;
+    }
+
+    if (output != stdout)
+    {
+        std::fclose(output);
+    }
+
+    std::cerr << "Converted " << reader.record_count() << " frame(s)" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,835 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "can_gateway.h"
+#include "hex_parse.h"
+#include "raw_socket.h"
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+#include <utility>
+
+static uint64_t realtime_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+}
+
+// Parses a hex CAN ID, IDs above 0x7FF or written with 8 digits are extended
+static bool parse_can_id(const std::string& text, canid_t& can_id)
+{
+    uint64_t id;
+    if (!parse_hex(text, CAN_EFF_MASK, id))
+    {
+        return false;
+    }
+
+    can_id = static_cast<canid_t>(id);
+    if (id > CAN_SFF_MASK || text.size() == 8)
+    {
+        can_id |= CAN_EFF_FLAG;
+    }
+    return true;
+}
+
+CanGateway::CanGateway(std::string_view source_name, std::string_view destination_name,
+                       const CanGatewayOptions& options)
+    : m_source_name {source_name}, m_destination_name {destination_name}, m_options {options}
+{
+}
+
+CanGateway::~CanGateway()
+{
+    if (m_source_socket >= 0)
+    {
+        close(m_source_socket);
+        m_source_socket = -1;
+    }
+
+    if (m_destination_socket >= 0)
+    {
+        close(m_destination_socket);
+        m_destination_socket = -1;
+    }
+
+    if (m_bridge_socket >= 0)
+    {
+        close(m_bridge_socket);
+        m_bridge_socket = -1;
+    }
+}
+
+bool CanGateway::parse_route(const std::string& text, GatewayRoute& route)
+{
+    route = {0, 0, false, 0, PayloadTransform::None, {}};
+
+    std::string match = text;
+    size_t comma = match.find(',');
+    if (comma != std::string::npos)
+    {
+        std::string transform = match.substr(comma + 1);
+        match.resize(comma);
+
+        size_t colon = transform.find(':');
+        std::string name = transform.substr(0, colon);
+        std::string operand = colon == std::string::npos ? std::string {} : transform.substr(colon + 1);
+
+        if (name == "and")
+        {
+            route.transform = PayloadTransform::And;
+        }
+        else if (name == "or")
+        {
+            route.transform = PayloadTransform::Or;
+        }
+        else if (name == "xor")
+        {
+            route.transform = PayloadTransform::Xor;
+        }
+        else if (name == "set")
+        {
+            route.transform = PayloadTransform::Set;
+        }
+        else
+        {
+            return false;
+        }
+
+        if (!parse_hex_bytes(operand, CANFD_MAX_DLEN, route.operand))
+        {
+            return false;
+        }
+    }
+
+    size_t equals = match.find('=');
+    if (equals != std::string::npos)
+    {
+        if (!parse_can_id(match.substr(equals + 1), route.new_id))
+        {
+            return false;
+        }
+        route.has_new_id = true;
+        match.resize(equals);
+    }
+
+    size_t colon = match.find(':');
+    if (!parse_can_id(match.substr(0, colon), route.can_id))
+    {
+        return false;
+    }
+
+    canid_t id_mask = (route.can_id & CAN_EFF_FLAG) ? CAN_EFF_MASK : CAN_SFF_MASK;
+    route.mask = id_mask;
+    if (colon != std::string::npos)
+    {
+        uint64_t mask;
+        if (!parse_hex(std::string_view {match}.substr(colon + 1), CAN_EFF_MASK, mask))
+        {
+            return false;
+        }
+        route.mask = static_cast<canid_t>(mask) & id_mask;
+    }
+
+    return true;
+}
+
+int CanGateway::initialize()
+{
+    if (m_options.is_bridge)
+    {
+        std::cout << "CAN Bridge from " << m_source_name << " to " << (m_options.bridge.is_unix ? "unix " : "udp ")
+                  << m_options.bridge.address << std::endl;
+    }
+    else
+    {
+        std::cout << "CAN Gateway from " << m_source_name << " to " << m_destination_name << std::endl;
+    }
+    std::cout << "Press Ctrl+C to exit.\n" << std::endl;
+
+    if (!m_options.is_bridge && m_source_name == m_destination_name)
+    {
+        std::cerr << "Source and destination must be different interfaces, forwarded frames would loop" << std::endl;
+        return 1;
+    }
+
+    if (!m_options.routes_path.empty() && load_routes())
+    {
+        return 1;
+    }
+
+    if (setup_routes() || setup_source_socket())
+    {
+        return 1;
+    }
+
+    if (m_options.is_bridge ? setup_bridge() : setup_destination_socket())
+    {
+        return 1;
+    }
+
+    setup_batches();
+
+    if (m_options.realtime.lock_memory)
+    {
+        lock_memory();
+        prefault(m_rx_frames.data(), m_rx_frames.size() * sizeof(canfd_frame));
+        prefault(m_rx_controls.data(), m_rx_controls.size() * sizeof(ControlBuffer));
+        prefault(m_tx_frames.data(), m_tx_frames.size() * sizeof(canfd_frame));
+        if (m_encoder)
+        {
+            prefault(const_cast<uint8_t*>(m_encoder->data()), m_encoder->capacity());
+        }
+    }
+
+    return 0;
+}
+
+int CanGateway::load_routes()
+{
+    const std::string& path = m_options.routes_path;
+    std::ifstream file {path};
+    std::string line;
+    unsigned int line_number = 0;
+
+    if (!file)
+    {
+        std::cerr << "Error opening routes file: " << path << std::endl;
+        return 1;
+    }
+
+    while (std::getline(file, line))
+    {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        line.erase(std::remove_if(line.begin(), line.end(), [](unsigned char c) { return std::isspace(c); }),
+                   line.end());
+        if (line.empty())
+        {
+            continue;
+        }
+
+        GatewayRoute route {0, 0, false, 0, PayloadTransform::None, {}};
+        if (!parse_route(line, route))
+        {
+            std::cerr << path << ":" << line_number << ": invalid route " << line << std::endl;
+            return 1;
+        }
+        m_options.routes.push_back(route);
+    }
+
+    return 0;
+}
+
+int CanGateway::setup_routes()
+{
+    std::vector<GatewayRoute>& routes = m_options.routes;
+
+    // Without routes every standard and every extended frame is forwarded as it is
+    if (routes.empty())
+    {
+        routes.push_back({0, 0, false, 0, PayloadTransform::None, {}});
+        routes.push_back({CAN_EFF_FLAG, 0, false, 0, PayloadTransform::None, {}});
+        std::cout << "Forwarding every frame unchanged" << std::endl;
+    }
+
+    m_route_counts.assign(routes.size(), 0);
+
+    for (size_t i = 0; i < routes.size(); i++)
+    {
+        const GatewayRoute& route = routes[i];
+        FrameHandler handler = [this, i](const ReceivedFrame& received) { forward(i, received); };
+        if (m_dispatcher.add(route.can_id, route.mask, std::move(handler)))
+        {
+            std::cerr << "Too many routes with extended IDs" << std::endl;
+            return 1;
+        }
+
+        std::cout << "Route " << i + 1 << ": ID=0x" << std::hex << std::uppercase << (route.can_id & CAN_EFF_MASK)
+                  << " MASK=0x" << route.mask;
+        std::cout << ((route.can_id & CAN_EFF_FLAG) ? " (extended)" : "");
+        if (route.has_new_id)
+        {
+            std::cout << " -> ID=0x" << (route.new_id & CAN_EFF_MASK)
+                      << ((route.new_id & CAN_EFF_FLAG) ? " (extended)" : "");
+        }
+        std::cout << std::dec;
+
+        static const char* const transform_names[] = {"", "and", "or", "xor", "set"};
+        if (route.transform != PayloadTransform::None)
+        {
+            std::cout << ", " << transform_names[static_cast<int>(route.transform)] << " " << route.operand.size()
+                      << " byte(s)";
+        }
+        std::cout << std::endl;
+    }
+
+    // Once for all routes, so a large routes file does not recompile the table per route
+    m_dispatcher.compile();
+
+    return 0;
+}
+
+int CanGateway::open_socket(const std::string& name, int& can_socket)
+{
+    can_socket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (can_socket < 0)
+    {
+        perror("Error while opening socket");
+        return 1;
+    }
+
+    // Classic and CAN FD frames are both forwarded, writes of CANFD_MTU need this as well
+    int enable_fd = 1;
+    if (setsockopt(can_socket, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable_fd, sizeof(enable_fd)) < 0)
+    {
+        perror("Warning: CAN FD frames not supported");
+    }
+
+    struct ifreq ifr {};
+    std::strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
+    if (ioctl(can_socket, SIOCGIFINDEX, &ifr) < 0)
+    {
+        perror("Error getting interface index");
+        return 1;
+    }
+
+    struct sockaddr_can addr {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+
+    if (bind(can_socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        perror("Error in socket bind");
+        return 1;
+    }
+
+    std::cout << "Interface " << name << " at index " << ifr.ifr_ifindex << std::endl;
+
+    return 0;
+}
+
+int CanGateway::setup_source_socket()
+{
+    if (open_socket(m_source_name, m_source_socket))
+    {
+        return 1;
+    }
+
+    // CAN_RAW_FILTER takes at most CAN_RAW_FILTER_MAX filters, with more routes frames are only matched here
+    if (m_options.routes.size() <= CAN_RAW_FILTER_MAX)
+    {
+        std::vector<can_filter> filters;
+        for (const GatewayRoute& route : m_options.routes)
+        {
+            filters.push_back({route.can_id, route.mask | CAN_EFF_FLAG});
+        }
+
+        if (setsockopt(m_source_socket, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(),
+                       static_cast<socklen_t>(filters.size() * sizeof(can_filter))) < 0)
+        {
+            perror("Error setting CAN filters");
+            return 1;
+        }
+    }
+
+    int enable_overflow_counter = 1;
+    if (setsockopt(m_source_socket, SOL_SOCKET, SO_RXQ_OVFL, &enable_overflow_counter,
+                   sizeof(enable_overflow_counter)) < 0)
+    {
+        perror("Warning: receive queue drops cannot be counted");
+    }
+
+    // Arrival times for the forwarding latency, without them it is measured from the return of recvmmsg()
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (setsockopt(m_source_socket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0)
+    {
+        perror("Warning: kernel timestamps not available");
+    }
+
+    int size = m_options.receive_buffer_size;
+    if (size > 0 && setsockopt(m_source_socket, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) < 0 &&
+        setsockopt(m_source_socket, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0)
+    {
+        perror("Warning: cannot set the receive buffer size");
+    }
+
+    return 0;
+}
+
+int CanGateway::setup_destination_socket()
+{
+    if (open_socket(m_destination_name, m_destination_socket))
+    {
+        return 1;
+    }
+
+    // Only sends, an empty filter list keeps the traffic of the destination bus out of its receive queue
+    if (setsockopt(m_destination_socket, SOL_CAN_RAW, CAN_RAW_FILTER, nullptr, 0) < 0)
+    {
+        perror("Error setting CAN filters");
+        return 1;
+    }
+
+    return 0;
+}
+
+int CanGateway::setup_bridge()
+{
+    m_bridge_socket = open_datagram_socket(m_options.bridge, false);
+    if (m_bridge_socket < 0)
+    {
+        return 1;
+    }
+
+    m_encoder = std::make_unique<DatagramEncoder>(m_options.datagram_size, m_source_name);
+    m_datagram_received_ns.reserve(m_encoder->capacity() / DATAGRAM_RECORD_HEADER_SIZE);
+
+    std::cout << "Packing frames into datagrams of up to " << m_encoder->capacity() << " bytes, sent at the latest "
+              << m_options.flush_timeout_ns / 1e6 << " ms after their first frame" << std::endl;
+
+    return 0;
+}
+
+void CanGateway::setup_batches()
+{
+    unsigned int batch_size = m_options.batch_size;
+
+    m_rx_frames.resize(batch_size);
+    m_rx_controls.resize(batch_size);
+    m_rx_iovecs.resize(batch_size);
+    m_rx_messages.resize(batch_size);
+
+    for (unsigned int i = 0; i < batch_size; i++)
+    {
+        m_rx_iovecs[i].iov_base = &m_rx_frames[i];
+        m_rx_iovecs[i].iov_len = sizeof(canfd_frame);
+
+        std::memset(&m_rx_messages[i], 0, sizeof(struct mmsghdr));
+        m_rx_messages[i].msg_hdr.msg_iov = &m_rx_iovecs[i];
+        m_rx_messages[i].msg_hdr.msg_iovlen = 1;
+        m_rx_messages[i].msg_hdr.msg_control = m_rx_controls[i].data;
+    }
+
+    m_tx_frames.assign(batch_size, canfd_frame {});
+    m_tx_iovecs.resize(batch_size);
+    m_tx_messages.resize(batch_size);
+    m_tx_received_ns.resize(batch_size);
+
+    for (unsigned int i = 0; i < batch_size; i++)
+    {
+        m_tx_iovecs[i].iov_base = &m_tx_frames[i];
+
+        std::memset(&m_tx_messages[i], 0, sizeof(struct mmsghdr));
+        m_tx_messages[i].msg_hdr.msg_iov = &m_tx_iovecs[i];
+        m_tx_messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    std::cout << "Forwarding up to " << batch_size << " frame(s) per syscall" << std::endl;
+}
+
+void CanGateway::run()
+{
+    m_is_running = true;
+
+    if (m_options.realtime.is_enabled())
+    {
+        apply_realtime(m_options.realtime, 0, "gateway");
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const uint64_t start_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+    uint64_t last_report_ns = start_ns;
+    uint64_t last_received_count = 0;
+    uint64_t last_forwarded_count = 0;
+
+    while (m_is_running)
+    {
+        if (!receive_batch())
+        {
+            break;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t now_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+        if (now_ns - last_report_ns >= 1'000'000'000)
+        {
+            print_interval(m_received_count - last_received_count, m_forwarded_count - last_forwarded_count,
+                           (now_ns - last_report_ns) / 1e9);
+            last_received_count = m_received_count;
+            last_forwarded_count = m_forwarded_count;
+            last_report_ns = now_ns;
+        }
+    }
+
+    // Frames still waiting for the flush timeout, or for the TX queue when the gateway was stopped
+    if (m_encoder)
+    {
+        send_datagram(false);
+    }
+    else
+    {
+        flush();
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    print_summary((static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec - start_ns) / 1e9);
+}
+
+void CanGateway::stop()
+{
+    m_is_running = false;
+}
+
+bool CanGateway::receive_batch()
+{
+    // The kernel shrinks msg_controllen to what it wrote, restore the full space for every call
+    for (struct mmsghdr& message : m_rx_messages)
+    {
+        message.msg_hdr.msg_controllen = sizeof(ControlBuffer::data);
+    }
+
+    // Blocking: wait for at least one frame, then also take whatever is already queued. A datagram being filled
+    // limits the wait to its flush timeout.
+    int flags = MSG_WAITFORONE;
+    if (m_encoder && m_encoder->frame_count() > 0)
+    {
+        if (!wait_for_frames())
+        {
+            send_datagram(true);
+            return true;
+        }
+        flags = MSG_DONTWAIT;
+    }
+
+    int count = recvmmsg(m_source_socket, m_rx_messages.data(), m_options.batch_size, flags, nullptr);
+
+    if (count < 0)
+    {
+        if (errno == EINTR || errno == EAGAIN)
+        {
+            return true;
+        }
+
+        perror("Error reading CAN frame");
+        return false;
+    }
+
+    m_receive_syscall_count++;
+    uint64_t received_ns = realtime_ns();
+    uint32_t drop_counter = m_drop_counter;
+
+    for (int i = 0; i < count; i++)
+    {
+        ReceivedFrame received {m_rx_frames[i], m_rx_messages[i].msg_len == CANFD_MTU, {}, false, 0};
+
+        if (!received.is_fd && m_rx_messages[i].msg_len != CAN_MTU)
+        {
+            std::cout << "Warning: incomplete CAN frame received" << std::endl;
+            continue;
+        }
+
+        // Only software timestamps are enabled, on the CLOCK_REALTIME the forwarding latency is measured against
+        read_control_messages(m_rx_messages[i].msg_hdr, received, drop_counter);
+        if (received.timestamp.tv_sec == 0 && received.timestamp.tv_nsec == 0)
+        {
+            received.timestamp = {static_cast<time_t>(received_ns / 1'000'000'000),
+                                  static_cast<long>(received_ns % 1'000'000'000)};
+        }
+
+        m_received_count++;
+        if (m_dispatcher.dispatch(received) == 0)
+        {
+            m_unrouted_count++;
+        }
+    }
+
+    // The counter is the socket's total, unsigned subtraction also covers it wrapping around
+    m_queue_drop_count += drop_counter - m_drop_counter;
+    m_drop_counter = drop_counter;
+
+    if (!m_encoder)
+    {
+        flush();
+    }
+
+    return true;
+}
+
+void CanGateway::forward(size_t route_index, const ReceivedFrame& received)
+{
+    const GatewayRoute& route = m_options.routes[route_index];
+    canfd_frame frame = received.frame;
+
+    if (route.has_new_id)
+    {
+        canid_t id_mask = (route.new_id & CAN_EFF_FLAG) ? CAN_EFF_MASK : CAN_SFF_MASK;
+        canid_t can_id = ((route.new_id & route.mask) | (frame.can_id & ~route.mask)) & id_mask;
+        frame.can_id = can_id | (route.new_id & CAN_EFF_FLAG) | (frame.can_id & CAN_RTR_FLAG);
+    }
+
+    size_t length = std::min<size_t>(route.operand.size(), frame.len);
+    for (size_t i = 0; i < length; i++)
+    {
+        switch (route.transform)
+        {
+        case PayloadTransform::None:
+            break;
+        case PayloadTransform::And:
+            frame.data[i] &= route.operand[i];
+            break;
+        case PayloadTransform::Or:
+            frame.data[i] |= route.operand[i];
+            break;
+        case PayloadTransform::Xor:
+            frame.data[i] ^= route.operand[i];
+            break;
+        case PayloadTransform::Set:
+            frame.data[i] = route.operand[i];
+            break;
+        }
+    }
+
+    m_route_counts[route_index]++;
+    uint64_t received_ns =
+        static_cast<uint64_t>(received.timestamp.tv_sec) * 1'000'000'000 + received.timestamp.tv_nsec;
+
+    if (m_encoder)
+    {
+        bridge_frame(frame, received.is_fd, received_ns);
+        return;
+    }
+
+    // A frame matching several routes can outgrow the batch
+    if (m_tx_count == m_tx_frames.size())
+    {
+        flush();
+    }
+
+    m_tx_frames[m_tx_count] = frame;
+    m_tx_iovecs[m_tx_count].iov_len = received.is_fd ? CANFD_MTU : CAN_MTU;
+    m_tx_received_ns[m_tx_count] = received_ns;
+    m_tx_count++;
+}
+
+void CanGateway::bridge_frame(const canfd_frame& frame, bool is_fd, uint64_t received_ns)
+{
+    CaptureRecord record {received_ns, frame.can_id, 0, frame.len, static_cast<uint8_t>(is_fd ? frame.flags : 0),
+                          is_fd ? CAPTURE_FLAG_FD : uint8_t {0}, 0, {}, 0};
+    std::memcpy(record.data, frame.data, std::min<size_t>(frame.len, CANFD_MAX_DLEN));
+
+    if (!m_encoder->add(record))
+    {
+        send_datagram(false);
+        m_encoder->add(record);
+    }
+
+    if (m_encoder->frame_count() == 1)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        m_datagram_deadline_ns =
+            static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec + m_options.flush_timeout_ns;
+    }
+
+    m_datagram_received_ns.push_back(received_ns);
+}
+
+// Returns false when the datagram's flush timeout passed before another frame arrived
+bool CanGateway::wait_for_frames()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t now_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+    if (now_ns >= m_datagram_deadline_ns)
+    {
+        return false;
+    }
+
+    uint64_t remaining_ns = m_datagram_deadline_ns - now_ns;
+    struct timespec timeout {static_cast<time_t>(remaining_ns / 1'000'000'000),
+                             static_cast<long>(remaining_ns % 1'000'000'000)};
+    struct pollfd pfd {m_source_socket, POLLIN, 0};
+
+    return ppoll(&pfd, 1, &timeout, nullptr) != 0;
+}
+
+void CanGateway::send_datagram(bool is_timeout)
+{
+    uint16_t frame_count = m_encoder->frame_count();
+    if (frame_count == 0)
+    {
+        return;
+    }
+
+    m_encoder->finish(m_sequence++);
+
+    ssize_t result;
+    do
+    {
+        result = send(m_bridge_socket, m_encoder->data(), m_encoder->size(), 0);
+    } while (result < 0 && errno == EINTR);
+
+    if (result < 0)
+    {
+        // Without a receiver UDP reports the ICMP error of an earlier datagram and Unix sockets refuse to connect,
+        // say so once until a datagram gets through again
+        if (!m_has_bridge_error)
+        {
+            perror("Error sending datagram");
+            m_has_bridge_error = true;
+        }
+        m_send_drop_count += frame_count;
+    }
+    else
+    {
+        m_has_bridge_error = false;
+
+        uint64_t sent_ns = realtime_ns();
+        for (uint64_t received_ns : m_datagram_received_ns)
+        {
+            uint64_t latency_ns = sent_ns > received_ns ? sent_ns - received_ns : 0;
+            m_latency.add(latency_ns);
+            m_interval_latency.add(latency_ns);
+        }
+
+        m_forwarded_count += frame_count;
+        m_send_syscall_count++;
+        m_datagram_count++;
+        m_datagram_bytes += m_encoder->size();
+        m_interval_datagram_count++;
+        m_interval_datagram_bytes += m_encoder->size();
+        if (is_timeout)
+        {
+            m_timeout_flush_count++;
+        }
+    }
+
+    m_encoder->reset();
+    m_datagram_received_ns.clear();
+}
+
+void CanGateway::flush()
+{
+    unsigned int index = 0;
+
+    // The batch is also sent after stop(), only a full TX queue then gives up on it
+    while (index < m_tx_count)
+    {
+        int result = sendmmsg(m_destination_socket, &m_tx_messages[index], m_tx_count - index, 0);
+
+        if (result > 0)
+        {
+            uint64_t sent_ns = realtime_ns();
+            for (int i = 0; i < result; i++)
+            {
+                uint64_t received_ns = m_tx_received_ns[index + i];
+                uint64_t latency_ns = sent_ns > received_ns ? sent_ns - received_ns : 0;
+                m_latency.add(latency_ns);
+                m_interval_latency.add(latency_ns);
+            }
+
+            m_send_syscall_count++;
+            m_forwarded_count += static_cast<unsigned int>(result);
+            index += static_cast<unsigned int>(result);
+            continue;
+        }
+
+        if (errno == ENOBUFS || errno == EAGAIN)
+        {
+            if (!m_is_running)
+            {
+                m_send_drop_count += m_tx_count - index;
+                break;
+            }
+
+            m_backpressure_count++;
+            wait_for_tx_queue(m_destination_socket);
+            continue;
+        }
+
+        if (errno == EINTR)
+        {
+            continue;
+        }
+
+        // Skip the frame that failed and keep going, a CAN FD frame on a classic interface fails with EINVAL
+        perror("Error forwarding CAN frame");
+        m_send_drop_count++;
+        index++;
+    }
+
+    m_tx_count = 0;
+}
+
+void CanGateway::print_interval(uint64_t received, uint64_t forwarded, double interval)
+{
+    std::cout << "Received " << static_cast<uint64_t>(received / interval) << " frames/s, forwarded "
+              << static_cast<uint64_t>(forwarded / interval) << " frames/s";
+    if (m_encoder && m_interval_datagram_count > 0)
+    {
+        std::cout << " in " << static_cast<uint64_t>(m_interval_datagram_count / interval) << " datagrams/s, fill "
+                  << 100.0 * m_interval_datagram_bytes / (m_interval_datagram_count * m_encoder->capacity()) << "%";
+    }
+    std::cout << ", latency";
+    m_interval_latency.print_percentiles(std::cout);
+    std::cout << std::endl;
+
+    m_interval_latency = {};
+    m_interval_datagram_count = 0;
+    m_interval_datagram_bytes = 0;
+}
+
+void CanGateway::print_summary(double elapsed) const
+{
+    std::cout << "Received " << m_received_count << " frame(s) in " << m_receive_syscall_count
+              << " syscall(s), forwarded " << m_forwarded_count << " in " << m_send_syscall_count
+              << " syscall(s) over " << elapsed << " s (" << (elapsed > 0 ? m_forwarded_count / elapsed : 0.0)
+              << " frames/s)" << std::endl;
+    std::cout << "Unrouted " << m_unrouted_count << ", receive queue drops " << m_queue_drop_count
+              << ", send failures " << m_send_drop_count << ", backpressure waits " << m_backpressure_count
+              << std::endl;
+
+    if (m_encoder && m_datagram_count > 0)
+    {
+        std::cout << "Sent " << m_datagram_count << " datagram(s) of up to " << m_encoder->capacity() << " bytes, "
+                  << static_cast<double>(m_forwarded_count) / m_datagram_count << " frames per datagram, fill ratio "
+                  << 100.0 * m_datagram_bytes / (m_datagram_count * m_encoder->capacity()) << "%, "
+                  << m_timeout_flush_count << " sent at the flush timeout" << std::endl;
+    }
+
+    std::cout << "Forwarding latency:";
+    m_latency.print_percentiles(std::cout);
+    std::cout << std::endl;
+
+    for (size_t i = 0; i < m_route_counts.size(); i++)
+    {
+        std::cout << "  Route " << i + 1 << ": " << m_route_counts[i] << " frame(s)" << std::endl;
+    }
+}
@@ -0,0 +1,164 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CAN_GATEWAY_H
+#define CAN_GATEWAY_H
+
+#include "frame_datagram.h"
+#include "frame_dispatcher.h"
+#include "latency_histogram.h"
+#include "raw_socket.h"
+#include "realtime.h"
+#include <linux/can.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <vector>
+
+enum class PayloadTransform
+{
+    None,
+    And, // Payload bytes ANDed with the operand
+    Or,  // Payload bytes ORed with the operand
+    Xor, // Payload bytes XORed with the operand
+    Set, // Payload bytes replaced by the operand
+};
+
+// Frames matching can_id under mask are forwarded, with the masked bits of their ID replaced by new_id and their
+// first operand.size() payload bytes transformed
+struct GatewayRoute
+{
+    canid_t can_id; // CAN_EFF_FLAG set for extended IDs
+    canid_t mask;
+    bool has_new_id;
+    canid_t new_id; // CAN_EFF_FLAG set to forward as an extended frame
+    PayloadTransform transform;
+    std::vector<uint8_t> operand;
+};
+
+struct CanGatewayOptions
+{
+    // Every route a frame matches forwards one copy of it, in route order. Without routes every frame is
+    // forwarded unchanged. The routes are also installed as CAN_RAW_FILTER on the source socket, so frames
+    // no route matches are dropped by the kernel.
+    std::vector<GatewayRoute> routes {};
+    std::string routes_path {}; // Routes file, one route per line, appended to routes
+
+    unsigned int batch_size {32}; // Frames per recvmmsg() and sendmmsg() call
+    int receive_buffer_size {0};  // Source socket SO_RCVBUF in bytes, 0 keeps the system default
+
+    // Bridge mode: pack the routed frames into datagrams sent to bridge instead of forwarding them to a CAN
+    // interface. A datagram goes out when the next frame would not fit into datagram_size bytes, or
+    // flush_timeout_ns after its first frame was added.
+    bool is_bridge {false};
+    DatagramEndpoint bridge {false, {}};
+    size_t datagram_size {1472}; // Fills a 1500 byte Ethernet MTU with UDP over IPv4
+    uint64_t flush_timeout_ns {10'000'000};
+
+    // Scheduling, CPU affinity and memory locking of the gateway thread
+    RealtimeOptions realtime {};
+};
+
+// Forwards frames from one CAN interface to another on a single thread: receives them in recvmmsg() batches,
+// looks up their routes in a compiled FrameDispatcher and sends the rewritten copies in sendmmsg() batches, or
+// packed into datagrams in bridge mode. It shares the frame types, dispatcher and real-time helpers of common/
+// with CanReceiver and CanSender but opens its two sockets itself: both classes own their sockets and run
+// loops, and chaining them would bring back the thread handoff between receiving and sending.
+class CanGateway
+{
+  public:
+    // destination_name is unused in bridge mode
+    CanGateway(std::string_view source_name, std::string_view destination_name, const CanGatewayOptions& options = {});
+    ~CanGateway();
+
+    CanGateway(const CanGateway&) = delete;
+    CanGateway& operator=(const CanGateway&) = delete;
+
+    // Parses "ID[:MASK][=NEWID][,OP:HEX]" with hex IDs, OP one of and, or, xor or set
+    static bool parse_route(const std::string& text, GatewayRoute& route);
+
+    int initialize();
+    void run();
+    void stop();
+
+  private:
+    std::string m_source_name {};
+    std::string m_destination_name {};
+    CanGatewayOptions m_options {};
+    int m_source_socket {-1};
+    int m_destination_socket {-1};
+    volatile bool m_is_running {false};
+    FrameDispatcher m_dispatcher {};
+    std::vector<uint64_t> m_route_counts {}; // Frames forwarded by each route
+
+    // Preallocated receive batch for recvmmsg()
+    std::vector<canfd_frame> m_rx_frames {};
+    std::vector<ControlBuffer> m_rx_controls {};
+    std::vector<struct iovec> m_rx_iovecs {};
+    std::vector<struct mmsghdr> m_rx_messages {};
+
+    // Preallocated forward batch for sendmmsg(), with the arrival time of every frame in it
+    std::vector<canfd_frame> m_tx_frames {};
+    std::vector<struct iovec> m_tx_iovecs {};
+    std::vector<struct mmsghdr> m_tx_messages {};
+    std::vector<uint64_t> m_tx_received_ns {};
+    unsigned int m_tx_count {0};
+
+    // Bridge mode datagram being filled, with the arrival time of every frame in it
+    int m_bridge_socket {-1};
+    std::unique_ptr<DatagramEncoder> m_encoder {};
+    std::vector<uint64_t> m_datagram_received_ns {};
+    uint64_t m_datagram_deadline_ns {0}; // CLOCK_MONOTONIC
+    uint32_t m_sequence {0};
+    bool m_has_bridge_error {false};
+
+    uint32_t m_drop_counter {0}; // Last SO_RXQ_OVFL value of the source socket
+    uint64_t m_received_count {0};
+    uint64_t m_receive_syscall_count {0};
+    uint64_t m_forwarded_count {0};
+    uint64_t m_send_syscall_count {0};
+    uint64_t m_unrouted_count {0};
+    uint64_t m_queue_drop_count {0};
+    uint64_t m_send_drop_count {0};
+    uint64_t m_backpressure_count {0};
+    uint64_t m_datagram_count {0};
+    uint64_t m_datagram_bytes {0};
+    uint64_t m_timeout_flush_count {0}; // Datagrams sent at the flush timeout rather than full
+    uint64_t m_interval_datagram_count {0};
+    uint64_t m_interval_datagram_bytes {0};
+    LatencyHistogram m_latency {};
+    LatencyHistogram m_interval_latency {};
+
+    int load_routes();
+    int setup_routes();
+    int open_socket(const std::string& name, int& can_socket);
+    int setup_source_socket();
+    int setup_destination_socket();
+    int setup_bridge();
+    void setup_batches();
+    bool receive_batch();
+    void forward(size_t route_index, const ReceivedFrame& received);
+    void bridge_frame(const canfd_frame& frame, bool is_fd, uint64_t received_ns);
+    bool wait_for_frames();
+    void send_datagram(bool is_timeout);
+    void flush();
+    void print_interval(uint64_t received, uint64_t forwarded, double interval);
+    void print_summary(double elapsed) const;
+};
+
+#endif // CAN_GATEWAY_H
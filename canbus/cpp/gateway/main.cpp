@@ -0,0 +1,205 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "can_gateway.h"
+#include <cstdlib>
+#include <getopt.h>
+#include <iostream>
+#include <memory>
+#include <signal.h>
+#include <string>
+
+// Global variables
+static std::unique_ptr<CanGateway> g_gateway;
+
+void signal_handler([[maybe_unused]] int sig)
+{
+    std::cout << "\nShutting down..." << std::endl;
+    if (g_gateway)
+    {
+        g_gateway->stop();
+    }
+}
+
+void print_usage(std::string_view program_name)
+{
+    std::cout << "Usage: " << program_name << " [OPTIONS] SOURCE DESTINATION" << std::endl;
+    std::cout << "       " << program_name << " [OPTIONS] -u HOST:PORT|-x PATH SOURCE" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  SOURCE                CAN interface to receive frames from" << std::endl;
+    std::cout << "  DESTINATION           CAN interface to forward frames to" << std::endl;
+    std::cout << "  -r, --route RULE      Forward frames matching hex ID[:MASK], as =NEWID with the masked ID bits"
+              << std::endl;
+    std::cout << "                        replaced, and with ,and:HEX ,or:HEX ,xor:HEX or ,set:HEX applied to the"
+              << std::endl;
+    std::cout << "                        payload. Repeatable, without routes every frame is forwarded." << std::endl;
+    std::cout << "  -f, --routes FILE     Read routes from FILE, one per line, '#' starts a comment" << std::endl;
+    std::cout << "  -b, --batch N         Frames per recvmmsg() and sendmmsg() call (default: 32)" << std::endl;
+    std::cout << "  -R, --rcvbuf BYTES    Source socket receive buffer size (default: system default)" << std::endl;
+    std::cout << "  -u, --udp HOST:PORT   Bridge: pack frames into UDP datagrams to HOST:PORT instead" << std::endl;
+    std::cout << "  -x, --unix PATH       Bridge: pack frames into Unix datagrams to PATH, @NAME for abstract"
+              << std::endl;
+    std::cout << "  -s, --size BYTES      Bridge datagram size (default: 1472)" << std::endl;
+    std::cout << "  -t, --timeout MS      Send a datagram at the latest MS after its first frame (default: 10)"
+              << std::endl;
+    std::cout << "  -S, --sched POLICY    Gateway thread scheduling: fifo:PRIO, rr:PRIO or other" << std::endl;
+    std::cout << "  -a, --affinity CPU    Pin the gateway thread to CPU" << std::endl;
+    std::cout << "  -L, --lock-memory     Lock memory and prefault the frame batches" << std::endl;
+    std::cout << "  -h, --help            Show this help message" << std::endl;
+    std::cout << std::endl << "Example: " << program_name << " vcan0 vcan1" << std::endl;
+    std::cout << "         " << program_name << " -r 100:700=300 -r 18FEF100=18FEF200,xor:FF vcan0 vcan1" << std::endl;
+    std::cout << "         " << program_name << " -f routes.txt -b 64 -S fifo:80 -a 2 -L can0 can1" << std::endl;
+    std::cout << "         " << program_name << " -u 127.0.0.1:5000 -t 5 vcan0" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    CanGatewayOptions options {};
+    int opt;
+    static struct option long_options[] = {{"route", required_argument, 0, 'r'},
+                                           {"routes", required_argument, 0, 'f'},
+                                           {"batch", required_argument, 0, 'b'},
+                                           {"rcvbuf", required_argument, 0, 'R'},
+                                           {"udp", required_argument, 0, 'u'},
+                                           {"unix", required_argument, 0, 'x'},
+                                           {"size", required_argument, 0, 's'},
+                                           {"timeout", required_argument, 0, 't'},
+                                           {"sched", required_argument, 0, 'S'},
+                                           {"affinity", required_argument, 0, 'a'},
+                                           {"lock-memory", no_argument, 0, 'L'},
+                                           {"help", no_argument, 0, 'h'},
+                                           {0, 0, 0, 0}};
+
+    // Install without SA_RESTART so a blocking receive returns EINTR and the gateway can shut down cleanly
+    struct sigaction action {};
+    action.sa_handler = signal_handler;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    while ((opt = getopt_long(argc, argv, "r:f:b:R:u:x:s:t:S:a:Lh", long_options, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+        case 'r':
+        {
+            GatewayRoute route {0, 0, false, 0, PayloadTransform::None, {}};
+            if (!CanGateway::parse_route(optarg, route))
+            {
+                std::cerr << "Invalid route: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.routes.push_back(route);
+            break;
+        }
+        case 'f':
+            options.routes_path = optarg;
+            break;
+        case 'b':
+        {
+            int batch_size = std::atoi(optarg);
+            if (batch_size <= 0)
+            {
+                std::cerr << "Invalid batch size: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.batch_size = static_cast<unsigned int>(batch_size);
+            break;
+        }
+        case 'R':
+        {
+            int receive_buffer_size = std::atoi(optarg);
+            if (receive_buffer_size <= 0)
+            {
+                std::cerr << "Invalid receive buffer size: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.receive_buffer_size = receive_buffer_size;
+            break;
+        }
+        case 'u':
+        case 'x':
+            options.is_bridge = true;
+            options.bridge = {opt == 'x', optarg};
+            break;
+        case 's':
+        {
+            // At least one CAN FD frame has to fit
+            long datagram_size = std::atol(optarg);
+            long minimum_size = sizeof(DatagramHeader) + DATAGRAM_RECORD_HEADER_SIZE + CANFD_MAX_DLEN;
+            if (datagram_size < minimum_size || datagram_size > static_cast<long>(DATAGRAM_MAX_SIZE))
+            {
+                std::cerr << "Invalid datagram size: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.datagram_size = static_cast<size_t>(datagram_size);
+            break;
+        }
+        case 't':
+        {
+            double timeout_ms = std::atof(optarg);
+            if (timeout_ms <= 0)
+            {
+                std::cerr << "Invalid flush timeout: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.flush_timeout_ns = static_cast<uint64_t>(timeout_ms * 1e6);
+            break;
+        }
+        case 'S':
+            if (!parse_scheduling(optarg, options.realtime))
+            {
+                std::cerr << "Invalid scheduling: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'a':
+            if (!parse_cpu_list(optarg, options.realtime.cpus))
+            {
+                std::cerr << "Invalid CPU list: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'L':
+            options.realtime.lock_memory = true;
+            break;
+        case 'h':
+            print_usage(argv[0]);
+            return EXIT_SUCCESS;
+        default:
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind != (options.is_bridge ? 1 : 2))
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    g_gateway = std::make_unique<CanGateway>(argv[optind], options.is_bridge ? "" : argv[optind + 1], options);
+
+    if (g_gateway->initialize())
+    {
+        std::cerr << "Failed to initialize CAN gateway" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    g_gateway->run();
+
+    return EXIT_SUCCESS;
+}
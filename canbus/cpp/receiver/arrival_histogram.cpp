@@ -0,0 +1,104 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "arrival_histogram.h"
+#include "latency_histogram.h"
+#include <algorithm>
+#include <vector>
+
+void ArrivalHistogram::add(canid_t can_id, const struct timespec& timestamp)
+{
+    uint64_t now_ns = static_cast<uint64_t>(timestamp.tv_sec) * 1'000'000'000 + timestamp.tv_nsec;
+    Entry& entry = m_entries[can_id];
+
+    // Timestamps can step backwards when the clock is adjusted, skip those gaps
+    if (entry.frame_count > 0 && now_ns >= entry.last_ns)
+    {
+        uint64_t gap_ns = now_ns - entry.last_ns;
+
+        entry.gap_count++;
+        entry.total_gap_ns += gap_ns;
+        entry.min_gap_ns = std::min(entry.min_gap_ns, gap_ns);
+        entry.max_gap_ns = std::max(entry.max_gap_ns, gap_ns);
+        entry.buckets[bucket_of(gap_ns)]++;
+    }
+
+    entry.last_ns = now_ns;
+    entry.frame_count++;
+}
+
+void ArrivalHistogram::report(std::ostream& out) const
+{
+    std::vector<canid_t> ids;
+    ids.reserve(m_entries.size());
+    for (const auto& [can_id, entry] : m_entries)
+    {
+        ids.push_back(can_id);
+    }
+    std::sort(ids.begin(), ids.end());
+
+    out << "Inter-arrival times per CAN ID:" << std::endl;
+
+    for (canid_t can_id : ids)
+    {
+        const Entry& entry = m_entries.at(can_id);
+
+        out << "  ID=0x" << std::hex << std::uppercase << (can_id & CAN_EFF_MASK) << std::dec
+            << " frames=" << entry.frame_count;
+
+        if (entry.gap_count == 0)
+        {
+            out << std::endl;
+            continue;
+        }
+
+        out << " min=";
+        print_duration(out, entry.min_gap_ns);
+        out << " mean=";
+        print_duration(out, entry.total_gap_ns / entry.gap_count);
+        out << " max=";
+        print_duration(out, entry.max_gap_ns);
+        out << std::endl << "   ";
+
+        for (size_t i = 0; i < BUCKET_COUNT; i++)
+        {
+            if (entry.buckets[i] == 0)
+            {
+                continue;
+            }
+
+            out << " <";
+            print_duration(out, 1000ULL << i);
+            out << ":" << entry.buckets[i];
+        }
+        out << std::endl;
+    }
+}
+
+size_t ArrivalHistogram::bucket_of(uint64_t gap_ns)
+{
+    uint64_t gap_us = gap_ns / 1000;
+    size_t bucket = 0;
+
+    while (gap_us > 0 && bucket < BUCKET_COUNT - 1)
+    {
+        gap_us >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
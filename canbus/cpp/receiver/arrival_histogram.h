@@ -0,0 +1,55 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ARRIVAL_HISTOGRAM_H
+#define ARRIVAL_HISTOGRAM_H
+
+#include <linux/can.h>
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <time.h>
+#include <unordered_map>
+
+// Per CAN ID histogram of the time between consecutive frames, in power-of-two microsecond buckets.
+// Bucket 0 counts gaps below 1us, bucket N counts gaps in [2^(N-1), 2^N) us.
+class ArrivalHistogram
+{
+  public:
+    static constexpr size_t BUCKET_COUNT = 32;
+
+    void add(canid_t can_id, const struct timespec& timestamp);
+    void report(std::ostream& out) const;
+
+  private:
+    struct Entry
+    {
+        uint64_t last_ns {0};
+        uint64_t frame_count {0};
+        uint64_t gap_count {0};
+        uint64_t min_gap_ns {UINT64_MAX};
+        uint64_t max_gap_ns {0};
+        uint64_t total_gap_ns {0};
+        std::array<uint64_t, BUCKET_COUNT> buckets {};
+    };
+
+    static size_t bucket_of(uint64_t gap_ns);
+
+    std::unordered_map<canid_t, Entry> m_entries {};
+};
+
+#endif // ARRIVAL_HISTOGRAM_H
@@ -0,0 +1,396 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "bus_statistics.h"
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <time.h>
+
+// Payload length of each CAN FD DLC
+static constexpr uint8_t DLC_LENGTHS[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+
+static unsigned int dlc_of(unsigned int length)
+{
+    unsigned int dlc = 0;
+    while (dlc < 15 && DLC_LENGTHS[dlc] < length)
+    {
+        dlc++;
+    }
+    return dlc;
+}
+
+// Only the frame processing thread writes, so a relaxed load and store is enough and cheaper than fetch_add
+static void bump(std::atomic<uint64_t>& counter, uint64_t value = 1)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static uint64_t monotonic_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+}
+
+static std::string format_id(canid_t can_id)
+{
+    char text[16];
+    std::snprintf(text, sizeof(text), (can_id & CAN_EFF_FLAG) ? "0x%08X" : "0x%03X", can_id & CAN_EFF_MASK);
+    return text;
+}
+
+BusStatistics::BusStatistics(uint32_t bitrate, uint32_t data_bitrate)
+    : m_entries {std::make_unique<Entry[]>(CAN_SFF_MASK + 1 + EXTENDED_CAPACITY)}, m_bitrate {bitrate},
+      m_previous_frames(CAN_SFF_MASK + 1 + EXTENDED_CAPACITY), m_previous_bus_ns(CAN_SFF_MASK + 1 + EXTENDED_CAPACITY),
+      m_previous_report_ns {monotonic_ns()}
+{
+    double bit_ns = 1e9 / bitrate;
+    double data_bit_ns = 1e9 / (data_bitrate > 0 ? data_bitrate : bitrate);
+
+    for (unsigned int is_extended = 0; is_extended < 2; is_extended++)
+    {
+        for (unsigned int dlc = 0; dlc < 16; dlc++)
+        {
+            uint64_t data_bits;
+            uint64_t classic_bits = frame_bits(is_extended, DLC_LENGTHS[std::min(dlc, 8U)], false, data_bits);
+            uint64_t fd_bits = frame_bits(is_extended, DLC_LENGTHS[dlc], true, data_bits);
+
+            m_frame_ns[2 * CLASSIC + is_extended][dlc] = static_cast<uint64_t>(classic_bits * bit_ns + 0.5);
+            m_frame_ns[2 * FD + is_extended][dlc] = static_cast<uint64_t>(fd_bits * bit_ns + 0.5);
+            m_frame_ns[2 * FD_BRS + is_extended][dlc] =
+                static_cast<uint64_t>((fd_bits - data_bits) * bit_ns + data_bits * data_bit_ns + 0.5);
+        }
+    }
+}
+
+uint64_t BusStatistics::frame_bits(bool is_extended, unsigned int length, bool is_fd, uint64_t& data_bits)
+{
+    uint64_t payload_bits = 8ULL * length;
+
+    if (!is_fd)
+    {
+        // SOF to the end of CRC is stuffed, one stuff bit per 4 in the worst case. The other 13 bits are the CRC
+        // delimiter, ACK slot and delimiter, EOF and intermission.
+        uint64_t stuffed_bits = (is_extended ? 54 : 34) + payload_bits;
+        data_bits = 0;
+        return stuffed_bits + (stuffed_bits - 1) / 4 + 13;
+    }
+
+    // Arbitration phase: SOF, ID, the control bits up to BRS
+    uint64_t arbitration_bits = is_extended ? 36 : 17;
+
+    // Data phase: ESI, DLC and payload with dynamic stuffing, then the stuff count, the CRC with its fixed stuff
+    // bits and the CRC delimiter
+    uint64_t crc_bits = length <= 16 ? 17 : 21;
+    uint64_t dynamic_bits = 5 + payload_bits;
+    data_bits = dynamic_bits + (dynamic_bits - 1) / 4 + 4 + crc_bits + (4 + crc_bits) / 4 + 1 + 1;
+
+    // ACK slot and delimiter, EOF and intermission run at the nominal bitrate again
+    return arbitration_bits + (arbitration_bits - 1) / 4 + data_bits + 12;
+}
+
+BusStatistics::Entry* BusStatistics::find_entry(canid_t can_id)
+{
+    if (!(can_id & CAN_EFF_FLAG))
+    {
+        return &m_entries[can_id];
+    }
+
+    size_t mask = EXTENDED_CAPACITY - 1;
+    size_t slot = (static_cast<uint32_t>(can_id * 0x9E3779B1U) >> 16) & mask;
+
+    for (size_t probe = 0; probe < MAX_PROBES; probe++)
+    {
+        Entry& entry = m_entries[CAN_SFF_MASK + 1 + ((slot + probe) & mask)];
+        canid_t key = entry.can_id.load(std::memory_order_relaxed);
+
+        if (key == can_id)
+        {
+            return &entry;
+        }
+
+        if (key == 0)
+        {
+            entry.can_id.store(can_id, std::memory_order_release);
+            return &entry;
+        }
+    }
+
+    return nullptr;
+}
+
+void BusStatistics::add(const canfd_frame& frame, bool is_fd, uint64_t now_ns)
+{
+    if (frame.can_id & CAN_ERR_FLAG)
+    {
+        return;
+    }
+
+    bool is_extended = frame.can_id & CAN_EFF_FLAG;
+    Entry* entry = find_entry(is_extended ? frame.can_id & (CAN_EFF_FLAG | CAN_EFF_MASK) : frame.can_id & CAN_SFF_MASK);
+    if (entry == nullptr)
+    {
+        bump(m_overflow_count);
+        return;
+    }
+
+    unsigned int dlc = dlc_of(frame.len);
+    FrameKind kind = !is_fd ? CLASSIC : ((frame.flags & CANFD_BRS) ? FD_BRS : FD);
+
+    uint64_t frame_count = entry->frame_count.load(std::memory_order_relaxed);
+    uint64_t last_ns = entry->last_ns.load(std::memory_order_relaxed);
+
+    // Timestamps can step backwards when the clock is adjusted, skip those gaps
+    if (frame_count > 0 && now_ns >= last_ns)
+    {
+        uint64_t gap_ns = now_ns - last_ns;
+
+        bump(entry->gap_count);
+        bump(entry->total_gap_ns, gap_ns);
+        if (gap_ns < entry->min_gap_ns.load(std::memory_order_relaxed))
+        {
+            entry->min_gap_ns.store(gap_ns, std::memory_order_relaxed);
+        }
+        if (gap_ns > entry->max_gap_ns.load(std::memory_order_relaxed))
+        {
+            entry->max_gap_ns.store(gap_ns, std::memory_order_relaxed);
+        }
+    }
+
+    entry->last_ns.store(now_ns, std::memory_order_relaxed);
+    bump(entry->bus_time_ns, m_frame_ns[2 * kind + is_extended][dlc]);
+    bump(entry->dlc_counts[dlc]);
+
+    uint32_t sequence = entry->payload_sequence.load(std::memory_order_relaxed);
+    entry->payload_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (unsigned int i = 0; i * 8 < frame.len; i++)
+    {
+        uint64_t word = 0;
+        for (unsigned int j = 0; j < 8 && i * 8 + j < frame.len; j++)
+        {
+            word |= static_cast<uint64_t>(frame.data[i * 8 + j]) << (8 * j);
+        }
+        entry->payload[i].store(word, std::memory_order_relaxed);
+    }
+    entry->payload_length.store(frame.len, std::memory_order_relaxed);
+    entry->payload_sequence.store(sequence + 2, std::memory_order_release);
+
+    // Counted last so report() never sees a frame whose payload and bus time are missing
+    entry->frame_count.store(frame_count + 1, std::memory_order_release);
+}
+
+void BusStatistics::take_snapshot(size_t slot, Snapshot& snapshot)
+{
+    Entry& entry = m_entries[slot];
+
+    snapshot.frame_count = entry.frame_count.load(std::memory_order_acquire);
+    snapshot.can_id = slot <= CAN_SFF_MASK ? static_cast<canid_t>(slot) : entry.can_id.load(std::memory_order_relaxed);
+
+    uint64_t bus_ns = entry.bus_time_ns.load(std::memory_order_relaxed);
+    snapshot.interval_frames = snapshot.frame_count - m_previous_frames[slot];
+    snapshot.interval_bus_ns = bus_ns - m_previous_bus_ns[slot];
+    m_previous_frames[slot] = snapshot.frame_count;
+    m_previous_bus_ns[slot] = bus_ns;
+
+    snapshot.gap_count = entry.gap_count.load(std::memory_order_relaxed);
+    snapshot.min_gap_ns = entry.min_gap_ns.load(std::memory_order_relaxed);
+    snapshot.max_gap_ns = entry.max_gap_ns.load(std::memory_order_relaxed);
+    snapshot.total_gap_ns = entry.total_gap_ns.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < snapshot.dlc_counts.size(); i++)
+    {
+        snapshot.dlc_counts[i] = entry.dlc_counts[i].load(std::memory_order_relaxed);
+    }
+
+    // Retry while the writer is in the middle of copying a payload
+    uint32_t sequence;
+    do
+    {
+        sequence = entry.payload_sequence.load(std::memory_order_acquire);
+        snapshot.payload_length = std::min<uint32_t>(entry.payload_length.load(std::memory_order_relaxed),
+                                                     CANFD_MAX_DLEN);
+        for (unsigned int i = 0; i < entry.payload.size(); i++)
+        {
+            uint64_t word = entry.payload[i].load(std::memory_order_relaxed);
+            for (unsigned int j = 0; j < 8; j++)
+            {
+                snapshot.payload[i * 8 + j] = static_cast<uint8_t>(word >> (8 * j));
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) || sequence != entry.payload_sequence.load(std::memory_order_relaxed));
+}
+
+void BusStatistics::report(std::ostream& out, StatisticsFormat format)
+{
+    std::vector<Snapshot> snapshots;
+    uint64_t now_ns = monotonic_ns();
+    double seconds = (now_ns - m_previous_report_ns) / 1e9;
+    uint64_t bus_ns = 0;
+
+    m_previous_report_ns = now_ns;
+
+    for (size_t slot = 0; slot < CAN_SFF_MASK + 1 + EXTENDED_CAPACITY; slot++)
+    {
+        if (m_entries[slot].frame_count.load(std::memory_order_relaxed) == 0)
+        {
+            continue;
+        }
+
+        snapshots.emplace_back();
+        take_snapshot(slot, snapshots.back());
+        bus_ns += snapshots.back().interval_bus_ns;
+    }
+
+    // Biggest share of the bus first
+    std::sort(snapshots.begin(), snapshots.end(), [](const Snapshot& a, const Snapshot& b) {
+        return a.interval_bus_ns != b.interval_bus_ns ? a.interval_bus_ns > b.interval_bus_ns
+                                                      : a.frame_count > b.frame_count;
+    });
+
+    double bus_load = seconds > 0 ? bus_ns / (seconds * 1e9) : 0.0;
+    uint64_t overflow_count = m_overflow_count.load(std::memory_order_relaxed);
+
+    // Formatted in one piece so concurrent output of other threads does not end up inside the report
+    std::ostringstream text;
+    if (format == StatisticsFormat::Json)
+    {
+        print_json(text, snapshots, seconds, bus_load, overflow_count);
+    }
+    else
+    {
+        print_table(text, snapshots, seconds, bus_load, overflow_count, m_bitrate);
+    }
+    out << text.str() << std::flush;
+}
+
+void BusStatistics::print_table(std::ostream& out, const std::vector<Snapshot>& snapshots, double seconds,
+                                double bus_load, uint64_t overflow_count, uint32_t bitrate)
+{
+    uint64_t interval_frames = 0;
+    for (const Snapshot& snapshot : snapshots)
+    {
+        interval_frames += snapshot.interval_frames;
+    }
+
+    out << std::fixed << std::setprecision(1) << "Bus load " << 100.0 * bus_load << "% of " << bitrate / 1000
+        << " kbit/s, " << (seconds > 0 ? interval_frames / seconds : 0.0) << " frames/s over " << seconds << " s";
+    if (overflow_count > 0)
+    {
+        out << ", " << overflow_count << " frame(s) of untracked extended IDs";
+    }
+    out << std::endl;
+
+    out << "          ID     frames   frames/s   load    min gap   mean gap    max gap  DLCs / last payload"
+        << std::endl;
+
+    for (const Snapshot& snapshot : snapshots)
+    {
+        double share = seconds > 0 ? snapshot.interval_bus_ns / (seconds * 1e9) : 0.0;
+
+        out << std::setw(12) << format_id(snapshot.can_id) << std::setw(11) << snapshot.frame_count << std::setw(11)
+            << (seconds > 0 ? snapshot.interval_frames / seconds : 0.0) << std::setw(6) << 100.0 * share << "%";
+
+        if (snapshot.gap_count > 0)
+        {
+            out << std::setw(11);
+            print_duration(out, snapshot.min_gap_ns);
+            out << std::setw(11);
+            print_duration(out, snapshot.total_gap_ns / snapshot.gap_count);
+            out << std::setw(11);
+            print_duration(out, snapshot.max_gap_ns);
+        }
+        else
+        {
+            out << std::setw(11) << "-" << std::setw(11) << "-" << std::setw(11) << "-";
+        }
+
+        out << " ";
+        for (size_t i = 0; i < snapshot.dlc_counts.size(); i++)
+        {
+            if (snapshot.dlc_counts[i] > 0)
+            {
+                out << " " << static_cast<int>(DLC_LENGTHS[i]) << ":" << snapshot.dlc_counts[i];
+            }
+        }
+
+        out << " /" << std::hex << std::uppercase << std::setfill('0');
+        for (uint32_t i = 0; i < snapshot.payload_length; i++)
+        {
+            out << " " << std::setw(2) << static_cast<int>(snapshot.payload[i]);
+        }
+        out << std::dec << std::setfill(' ') << std::endl;
+    }
+}
+
+void BusStatistics::print_json(std::ostream& out, const std::vector<Snapshot>& snapshots, double seconds,
+                               double bus_load, uint64_t overflow_count)
+{
+    uint64_t interval_frames = 0;
+    for (const Snapshot& snapshot : snapshots)
+    {
+        interval_frames += snapshot.interval_frames;
+    }
+
+    out << std::fixed << std::setprecision(3) << "{\"seconds\":" << seconds
+        << ",\"frames_per_second\":" << (seconds > 0 ? interval_frames / seconds : 0.0)
+        << ",\"bus_load\":" << bus_load << ",\"untracked_frames\":" << overflow_count << ",\"ids\":[";
+
+    for (size_t n = 0; n < snapshots.size(); n++)
+    {
+        const Snapshot& snapshot = snapshots[n];
+        double share = seconds > 0 ? snapshot.interval_bus_ns / (seconds * 1e9) : 0.0;
+
+        out << (n > 0 ? "," : "") << "{\"id\":\"" << format_id(snapshot.can_id)
+            << "\",\"frames\":" << snapshot.frame_count
+            << ",\"frames_per_second\":" << (seconds > 0 ? snapshot.interval_frames / seconds : 0.0)
+            << ",\"bus_load\":" << share;
+
+        if (snapshot.gap_count > 0)
+        {
+            out << ",\"min_gap_ns\":" << snapshot.min_gap_ns
+                << ",\"mean_gap_ns\":" << snapshot.total_gap_ns / snapshot.gap_count
+                << ",\"max_gap_ns\":" << snapshot.max_gap_ns;
+        }
+
+        out << ",\"dlc\":{";
+        bool is_first = true;
+        for (size_t i = 0; i < snapshot.dlc_counts.size(); i++)
+        {
+            if (snapshot.dlc_counts[i] > 0)
+            {
+                out << (is_first ? "" : ",") << "\"" << static_cast<int>(DLC_LENGTHS[i])
+                    << "\":" << snapshot.dlc_counts[i];
+                is_first = false;
+            }
+        }
+
+        out << "},\"last\":\"" << std::hex << std::uppercase << std::setfill('0');
+        for (uint32_t i = 0; i < snapshot.payload_length; i++)
+        {
+            out << std::setw(2) << static_cast<int>(snapshot.payload[i]);
+        }
+        out << std::dec << std::setfill(' ') << "\"}";
+    }
+
+    out << "]}" << std::endl;
+}
@@ -0,0 +1,124 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef BUS_STATISTICS_H
+#define BUS_STATISTICS_H
+
+#include <linux/can.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+enum class StatisticsFormat
+{
+    Table,
+    Json, // One JSON object per line
+};
+
+// Per CAN ID frame counts, inter-arrival gaps, DLC distribution and last payload, plus an estimate of the bus
+// load. add() is called by the one thread processing frames and report() by another, so every counter is a
+// relaxed atomic the writer updates with a plain load and store, no locked instructions on the receive path.
+// Standard IDs index a dense table, extended IDs an open-addressing table of EXTENDED_CAPACITY slots.
+class BusStatistics
+{
+  public:
+    static constexpr size_t EXTENDED_CAPACITY = 4096;
+
+    // Data phase of CAN FD frames with BRS runs at data_bitrate, 0 means the same as bitrate
+    BusStatistics(uint32_t bitrate, uint32_t data_bitrate);
+
+    BusStatistics(const BusStatistics&) = delete;
+    BusStatistics& operator=(const BusStatistics&) = delete;
+
+    void add(const canfd_frame& frame, bool is_fd, uint64_t now_ns);
+
+    // Rates and bus load cover the time since the previous report
+    void report(std::ostream& out, StatisticsFormat format);
+
+  private:
+    // Extended IDs probe at most this many slots before counting the frame as overflow
+    static constexpr size_t MAX_PROBES = 64;
+
+    enum FrameKind
+    {
+        CLASSIC,
+        FD,
+        FD_BRS,
+        FRAME_KIND_COUNT,
+    };
+
+    struct Entry
+    {
+        // Stored first when the entry is claimed. frame_count is the release store readers acquire, a non-zero
+        // frame_count makes can_id and every other field of the frame visible.
+        std::atomic<canid_t> can_id {0};
+        std::atomic<uint64_t> frame_count {0};
+        std::atomic<uint64_t> bus_time_ns {0};
+        std::atomic<uint64_t> last_ns {0};
+        std::atomic<uint64_t> gap_count {0};
+        std::atomic<uint64_t> min_gap_ns {UINT64_MAX};
+        std::atomic<uint64_t> max_gap_ns {0};
+        std::atomic<uint64_t> total_gap_ns {0};
+        std::array<std::atomic<uint64_t>, 16> dlc_counts {};
+
+        // Last payload behind a sequence lock, odd while the writer is copying it
+        std::atomic<uint32_t> payload_sequence {0};
+        std::atomic<uint32_t> payload_length {0};
+        std::array<std::atomic<uint64_t>, CANFD_MAX_DLEN / 8> payload {};
+    };
+
+    // Consistent copy of one entry taken by report()
+    struct Snapshot
+    {
+        canid_t can_id;
+        uint64_t frame_count;
+        uint64_t interval_frames;
+        uint64_t interval_bus_ns;
+        uint64_t gap_count;
+        uint64_t min_gap_ns;
+        uint64_t max_gap_ns;
+        uint64_t total_gap_ns;
+        std::array<uint64_t, 16> dlc_counts;
+        uint32_t payload_length;
+        uint8_t payload[CANFD_MAX_DLEN];
+    };
+
+    std::unique_ptr<Entry[]> m_entries {}; // CAN_SFF_MASK + 1 standard slots, then EXTENDED_CAPACITY extended
+    std::atomic<uint64_t> m_overflow_count {0};
+    uint32_t m_bitrate {0};
+
+    // Bus time of one frame by DLC, worst-case bit stuffing included. Row is 2 * FrameKind + is_extended.
+    std::array<std::array<uint64_t, 16>, 2 * FRAME_KIND_COUNT> m_frame_ns {};
+
+    // Owned by the reporting thread
+    std::vector<uint64_t> m_previous_frames {};
+    std::vector<uint64_t> m_previous_bus_ns {};
+    uint64_t m_previous_report_ns {0};
+
+    Entry* find_entry(canid_t can_id);
+    void take_snapshot(size_t slot, Snapshot& snapshot);
+    static uint64_t frame_bits(bool is_extended, unsigned int length, bool is_fd, uint64_t& data_bits);
+    static void print_table(std::ostream& out, const std::vector<Snapshot>& snapshots, double seconds,
+                            double bus_load, uint64_t overflow_count, uint32_t bitrate);
+    static void print_json(std::ostream& out, const std::vector<Snapshot>& snapshots, double seconds,
+                           double bus_load, uint64_t overflow_count);
+};
+
+#endif // BUS_STATISTICS_H
@@ -16,151 +16,1715 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "can_receiver.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
 #include <cstring>
 #include <iostream>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
 #include <net/if.h>
+#include <net/if_arp.h>
+#include <poll.h>
+#include <signal.h>
+#include <thread>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <utility>
 
-CanReceiver::CanReceiver(std::string_view interface_name) : m_interface_name {interface_name} {}
+// Packet ring geometry, a 64 KiB block holds a few hundred CAN FD frames
+static constexpr unsigned int PACKET_BLOCK_SIZE = 1 << 16;
+static constexpr unsigned int PACKET_BLOCK_COUNT = 16;
+
+// Provided buffers shared by the multishot receives of all sockets, each holds one frame
+static constexpr uint16_t URING_BUFFER_GROUP = 0;
+static constexpr unsigned int URING_BUFFER_COUNT = 1024;
+
+// Marks the user_data of single receives, which carries the batch slot instead of the socket index
+static constexpr uint64_t URING_SINGLE_RECEIVE = 1ULL << 32;
+
+static double cpu_seconds()
+{
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+CanReceiver::CanReceiver(const std::vector<std::string>& interface_names, const CanReceiverOptions& options)
+    : m_interface_names {interface_names}, m_options {options}
+{
+    if (m_options.batch_size == 0)
+    {
+        m_options.batch_size = 1;
+    }
+
+    // Recording arrivals is the first handler of every ID, initialize() adds printing or capturing after the
+    // application handlers
+    FrameHandler record = [this](const ReceivedFrame& received) { record_arrival(received); };
+    m_dispatcher.add(0, 0, record);
+    m_dispatcher.add(CAN_EFF_FLAG, 0, record);
+}
 
 CanReceiver::~CanReceiver()
 {
-    if (m_socket >= 0)
+    for (const HwTimestampConfig& saved : m_hw_timestamps)
+    {
+        restore_hw_timestamps(m_sockets.front().socket, saved);
+    }
+
+    for (InterfaceSocket& can_socket : m_sockets)
+    {
+        close(can_socket.socket);
+    }
+    m_sockets.clear();
+
+    if (m_epoll >= 0)
     {
-        close(m_socket);
-        m_socket = -1;
+        close(m_epoll);
+        m_epoll = -1;
     }
 }
 
 int CanReceiver::initialize()
 {
-    std::cout << "CAN Receiver starting on interface: " << m_interface_name << std::endl;
+    std::cout << "CAN Receiver starting on interface(s):";
+    for (const std::string& name : m_interface_names)
+    {
+        std::cout << " " << name;
+    }
+    std::cout << std::endl;
     std::cout << "Press Ctrl+C to exit.\n" << std::endl;
 
-    if (setup_socket())
+    if (m_options.use_isotp)
+    {
+        return open_isotp();
+    }
+
+    if (m_options.use_j1939)
+    {
+        return open_j1939();
+    }
+
+    if (m_options.use_packet_mmap && m_options.use_io_uring)
+    {
+        std::cout << "Warning: The packet ring is read without io_uring" << std::endl;
+        m_options.use_io_uring = false;
+    }
+
+    if (m_options.use_packet_mmap && m_options.use_hw_timestamps)
+    {
+        std::cout << "Warning: The packet ring is read without hardware timestamps" << std::endl;
+        m_options.use_hw_timestamps = false;
+    }
+
+    for (const std::string& name : m_interface_names)
+    {
+        if (m_options.use_packet_mmap ? open_packet_ring(name) : open_interface(name))
+        {
+            return 1;
+        }
+    }
+
+    // io_uring waits on all sockets itself
+    if (m_sockets.size() > 1 && !m_options.use_io_uring && setup_epoll())
     {
         return 1;
     }
 
-    if (bind_socket())
+    if (m_options.use_packet_mmap)
+    {
+        if (!m_options.filters.empty())
+        {
+            std::cout << "Matching " << m_options.filters.size() << " filter(s) in userspace" << std::endl;
+        }
+    }
+    else
+    {
+        // Without multishot receive every socket needs at least one batch slot to keep a receive queued
+        if (m_options.use_io_uring)
+        {
+            m_options.batch_size = std::max(m_options.batch_size, static_cast<unsigned int>(m_sockets.size()));
+        }
+
+        setup_batch();
+
+        if (m_options.use_io_uring && setup_uring())
+        {
+            return 1;
+        }
+    }
+
+    if (!m_options.capture_path.empty() && setup_capture())
     {
         return 1;
     }
 
+    if (!m_options.dbc_path.empty())
+    {
+        if (m_is_capturing)
+        {
+            std::cout << "Warning: Frames are captured, not printed, DBC file is not used" << std::endl;
+        }
+        else
+        {
+            if (m_dbc.load(m_options.dbc_path))
+            {
+                return 1;
+            }
+            m_signal_values.resize(m_dbc.max_signals());
+        }
+    }
+
+    if (m_options.statistics_interval_ms > 0)
+    {
+        m_bus_statistics = std::make_unique<BusStatistics>(m_options.bitrate, m_options.data_bitrate);
+    }
+
+    if (m_options.ring_capacity > 0)
+    {
+        m_ring = std::make_unique<SpscRing<ReceivedFrame>>(m_options.ring_capacity);
+        std::cout << "Processing frames on a separate thread, ring capacity " << m_ring->capacity() << std::endl;
+    }
+
+    if (m_options.realtime.lock_memory)
+    {
+        lock_memory();
+        prefault_buffers();
+    }
+
+    FrameHandler output = [this](const ReceivedFrame& received) { output_frame(received); };
+    m_dispatcher.add(0, 0, output);
+    m_dispatcher.add(CAN_EFF_FLAG, 0, output);
+
     return 0;
 }
 
-int CanReceiver::setup_socket()
+int CanReceiver::open_interface(const std::string& name)
 {
-    m_socket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
-    if (m_socket < 0)
+    InterfaceSocket can_socket {name, 0, -1, 0};
+
+    if (setup_socket(can_socket))
+    {
+        return 1;
+    }
+    m_sockets.push_back(can_socket);
+
+    // Install filters before binding so no unfiltered frame is queued in between
+    if (setup_filters(can_socket.socket))
+    {
+        return 1;
+    }
+
+    if (bind_socket(m_sockets.back()))
     {
-        perror("Error while opening socket");
         return 1;
     }
 
+    if (name == "any")
+    {
+        if (find_can_interfaces())
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        m_interfaces.push_back({name, m_sockets.back().ifindex, 0});
+        setup_timestamping(can_socket.socket, name);
+    }
+
     return 0;
 }
 
-int CanReceiver::bind_socket()
+int CanReceiver::open_packet_ring(const std::string& name)
 {
-    struct ifreq ifr;
-    struct sockaddr_can addr;
+    // A packet socket binds to one interface, there is no equivalent of the CAN_RAW "any" socket
+    if (name == "any")
+    {
+        std::cerr << "Error: packet rings need named interfaces, not \"any\"" << std::endl;
+        return 1;
+    }
 
-    std::strcpy(ifr.ifr_name, m_interface_name.c_str());
-    if (ioctl(m_socket, SIOCGIFINDEX, &ifr) < 0)
+    int ifindex = static_cast<int>(if_nametoindex(name.c_str()));
+    if (ifindex == 0)
     {
         perror("Error getting interface index");
         return 1;
     }
 
-    addr.can_family = AF_CAN;
-    addr.can_ifindex = ifr.ifr_ifindex;
+    auto ring = std::make_unique<PacketRing>();
+    if (ring->open(ifindex, PACKET_BLOCK_SIZE, PACKET_BLOCK_COUNT, m_options.packet_block_timeout_ms))
+    {
+        return 1;
+    }
+
+    std::cout << "Interface " << name << " at index " << ifindex << ", packet ring of " << PACKET_BLOCK_COUNT
+              << " x " << PACKET_BLOCK_SIZE / 1024 << " KiB blocks, " << m_options.packet_block_timeout_ms
+              << " ms block timeout" << std::endl;
+
+    m_packet_rings.push_back(std::move(ring));
+    m_interfaces.push_back({name, ifindex, 0});
+
+    return 0;
+}
 
-    std::cout << "Interface " << m_interface_name << " at index " << ifr.ifr_ifindex << std::endl;
+int CanReceiver::open_isotp()
+{
+    const IsoTpOptions& isotp = m_options.isotp;
 
-    if (bind(m_socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    // Messages are reassembled per address pair, a socket bound to every interface would mix transfers
+    if (m_interface_names.size() != 1 || m_interface_names.front() == "any")
+    {
+        std::cerr << "Error: ISO-TP needs exactly one named interface" << std::endl;
+        return 1;
+    }
+
+    // Messages are handled on the receiving thread
+    m_options.ring_capacity = 0;
+    if (!m_options.capture_path.empty())
+    {
+        std::cout << "Warning: ISO-TP messages are not captured" << std::endl;
+    }
+
+    if (m_isotp.open(m_interface_names.front(), isotp))
     {
-        perror("Error in socket bind");
         return 1;
     }
 
+    std::cout << "ISO-TP on " << m_interface_names.front() << " from 0x" << std::hex << std::uppercase
+              << (isotp.rx_id & CAN_EFF_MASK) << " to 0x" << (isotp.tx_id & CAN_EFF_MASK) << std::dec
+              << ", block size " << static_cast<int>(isotp.block_size) << ", STmin 0x" << std::hex
+              << static_cast<int>(isotp.stmin) << std::dec << (isotp.is_fd ? ", CAN FD" : "")
+              << (isotp.use_padding ? ", padded" : "") << std::endl;
+
+    const std::string& name = m_interface_names.front();
+    m_interfaces.push_back({name, static_cast<int>(if_nametoindex(name.c_str())), 0});
+
     return 0;
 }
 
-void CanReceiver::run()
+int CanReceiver::open_j1939()
 {
-    m_is_running = true;
+    const J1939Options& j1939 = m_options.j1939;
 
-    while (m_is_running)
+    if (m_interface_names.size() != 1 || m_interface_names.front() == "any")
     {
-        can_frame frame;
-        ssize_t nbytes = read(m_socket, &frame, sizeof(can_frame));
+        std::cerr << "Error: J1939 needs exactly one named interface" << std::endl;
+        return 1;
+    }
+
+    // Messages are handled on the receiving thread
+    m_options.ring_capacity = 0;
+    if (!m_options.capture_path.empty())
+    {
+        std::cout << "Warning: J1939 messages are not captured" << std::endl;
+    }
+
+    const std::string& name = m_interface_names.front();
+    if (m_j1939.open(name, j1939))
+    {
+        return 1;
+    }
 
-        if (nbytes < 0)
+    std::cout << "J1939 on " << name;
+    if (j1939.pgns.empty())
+    {
+        std::cout << ", all PGNs";
+    }
+    else
+    {
+        std::cout << ", PGNs" << std::hex << std::uppercase;
+        for (pgn_t pgn : j1939.pgns)
         {
-            perror("Error reading CAN frame");
-            break;
+            std::cout << " 0x" << pgn;
+        }
+        std::cout << std::dec;
+    }
+    std::cout << (j1939.is_promiscuous ? ", promiscuous" : "") << std::endl;
+
+    m_interfaces.push_back({name, static_cast<int>(if_nametoindex(name.c_str())), 0});
+
+    return 0;
+}
+
+int CanReceiver::setup_socket(InterfaceSocket& can_socket)
+{
+    can_socket.socket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (can_socket.socket < 0)
+    {
+        perror("Error while opening socket");
+        return 1;
+    }
+
+    // Accept CAN FD frames in addition to classic ones, reads then return either CAN_MTU or CANFD_MTU bytes
+    int enable_fd = 1;
+    if (setsockopt(can_socket.socket, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable_fd, sizeof(enable_fd)) < 0)
+    {
+        perror("Warning: CAN FD frames not supported");
+    }
+
+    // Every received message then carries the number of frames the receive queue has dropped so far
+    int enable_overflow_counter = 1;
+    if (setsockopt(can_socket.socket, SOL_SOCKET, SO_RXQ_OVFL, &enable_overflow_counter,
+                   sizeof(enable_overflow_counter)) < 0)
+    {
+        perror("Warning: receive queue drops cannot be counted");
+    }
+
+    if (m_options.receive_buffer_size > 0)
+    {
+        setup_receive_buffer(can_socket.socket);
+    }
+
+    return 0;
+}
+
+void CanReceiver::setup_receive_buffer(int socket)
+{
+    // SO_RCVBUFFORCE may exceed net.core.rmem_max but needs CAP_NET_ADMIN, SO_RCVBUF is capped at rmem_max
+    int size = m_options.receive_buffer_size;
+    if (setsockopt(socket, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) < 0 &&
+        setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0)
+    {
+        perror("Warning: cannot set the receive buffer size");
+        return;
+    }
+
+    // The kernel doubles the value for its bookkeeping overhead and reports the doubled size
+    int actual = 0;
+    socklen_t length = sizeof(actual);
+    getsockopt(socket, SOL_SOCKET, SO_RCVBUF, &actual, &length);
+
+    std::cout << "Receive buffer " << actual << " bytes";
+    if (actual / 2 < size)
+    {
+        std::cout << ", less than requested, raise net.core.rmem_max or run with CAP_NET_ADMIN";
+    }
+    std::cout << std::endl;
+}
+
+int CanReceiver::setup_filters(int socket)
+{
+    const std::vector<can_filter>& filters = m_options.filters;
+
+    if (!filters.empty())
+    {
+        if (setsockopt(socket, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(),
+                       static_cast<socklen_t>(filters.size() * sizeof(can_filter))) < 0)
+        {
+            perror("Error setting CAN filters");
+            return 1;
         }
 
-        if (nbytes < static_cast<ssize_t>(sizeof(can_frame)))
+        for (const can_filter& filter : filters)
         {
-            std::cout << "Warning: incomplete CAN frame received" << std::endl;
-            continue;
+            std::cout << "Filter: " << ((filter.can_id & CAN_INV_FILTER) ? "NOT " : "") << "ID=0x" << std::hex
+                      << std::uppercase << (filter.can_id & CAN_EFF_MASK) << " MASK=0x"
+                      << (filter.can_mask & CAN_EFF_MASK) << std::dec
+                      << ((filter.can_id & CAN_EFF_FLAG) ? " (extended)" : "") << std::endl;
         }
+    }
 
-        process_frame(frame);
+    if (m_options.join_filters)
+    {
+        int join = 1;
+        if (setsockopt(socket, SOL_CAN_RAW, CAN_RAW_JOIN_FILTERS, &join, sizeof(join)) < 0)
+        {
+            perror("Error joining CAN filters");
+            return 1;
+        }
+    }
 
-        if (is_end_message(frame))
+    if (m_options.error_mask)
+    {
+        can_err_mask_t error_mask = m_options.error_mask;
+        if (setsockopt(socket, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &error_mask, sizeof(error_mask)) < 0)
         {
-            std::cout << "Received END message, stopping receiver" << std::endl;
-            break;
+            perror("Error setting CAN error mask");
+            return 1;
         }
     }
+
+    return 0;
 }
 
-void CanReceiver::stop()
+int CanReceiver::bind_socket(InterfaceSocket& can_socket)
 {
-    m_is_running = false;
+    struct ifreq ifr {};
+    struct sockaddr_can addr {};
+
+    // Interface index 0 binds to all CAN interfaces, frames are then told apart by their source address
+    if (can_socket.name != "any")
+    {
+        std::strncpy(ifr.ifr_name, can_socket.name.c_str(), IFNAMSIZ - 1);
+        if (ioctl(can_socket.socket, SIOCGIFINDEX, &ifr) < 0)
+        {
+            perror("Error getting interface index");
+            return 1;
+        }
+    }
+
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    can_socket.ifindex = ifr.ifr_ifindex;
+
+    std::cout << "Interface " << can_socket.name << " at index " << ifr.ifr_ifindex << std::endl;
+
+    if (bind(can_socket.socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        perror("Error in socket bind");
+        return 1;
+    }
+
+    return 0;
 }
 
-void CanReceiver::process_frame(const can_frame& frame)
+int CanReceiver::find_can_interfaces()
 {
-    print_frame(frame);
+    struct if_nameindex* names = if_nameindex();
+    if (names == nullptr)
+    {
+        perror("Error listing interfaces");
+        return 1;
+    }
+
+    for (struct if_nameindex* entry = names; entry->if_index != 0; entry++)
+    {
+        struct ifreq ifr {};
+        std::strncpy(ifr.ifr_name, entry->if_name, IFNAMSIZ - 1);
+
+        if (ioctl(m_sockets.back().socket, SIOCGIFHWADDR, &ifr) == 0 && ifr.ifr_hwaddr.sa_family == ARPHRD_CAN)
+        {
+            std::cout << "Found CAN interface " << entry->if_name << " at index " << entry->if_index << std::endl;
+            m_interfaces.push_back({entry->if_name, static_cast<int>(entry->if_index), 0});
+            setup_timestamping(m_sockets.back().socket, entry->if_name);
+        }
+    }
+
+    if_freenameindex(names);
+
+    return 0;
 }
 
-void CanReceiver::print_frame(const can_frame& frame)
+void CanReceiver::setup_timestamping(int socket, const std::string& interface_name)
 {
-    std::cout << "Received: ID=0x" << std::hex << std::uppercase << frame.can_id << std::dec
-              << ", DLC=" << static_cast<int>(frame.can_dlc) << ", Data=";
+    // Ask the controller to timestamp received frames, most CAN drivers do not support this and the kernel
+    // software timestamp is used instead
+    bool has_hw_timestamps = false;
+    if (m_options.use_hw_timestamps)
+    {
+        HwTimestampConfig saved {};
+        has_hw_timestamps = enable_hw_timestamps(socket, interface_name, false, saved);
+        if (has_hw_timestamps)
+        {
+            m_hw_timestamps.push_back(saved);
+        }
+        else
+        {
+            perror("Warning: hardware timestamps not available");
+        }
+    }
 
-    // Print hex data
-    for (int i = 0; i < frame.can_dlc; i++)
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_RX_HARDWARE |
+                SOF_TIMESTAMPING_RAW_HARDWARE;
+    if (setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0)
     {
-        printf("%02X ", frame.data[i]);
+        perror("Warning: kernel timestamps not available");
+        return;
     }
 
-    // Print as string if printable
-    std::cout << "('";
-    for (int i = 0; i < frame.can_dlc; i++)
+    std::cout << "Timestamping frames from " << interface_name << " in "
+              << (has_hw_timestamps ? "hardware" : "software") << std::endl;
+}
+
+int CanReceiver::setup_epoll()
+{
+    m_epoll = epoll_create1(0);
+    if (m_epoll < 0)
+    {
+        perror("Error creating epoll instance");
+        return 1;
+    }
+
+    for (const InterfaceSocket& can_socket : m_sockets)
     {
-        if (frame.data[i] >= 32 && frame.data[i] <= 126)
+        struct epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.u32 = static_cast<uint32_t>(&can_socket - m_sockets.data());
+
+        if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, can_socket.socket, &event) < 0)
         {
-            std::cout << static_cast<char>(frame.data[i]);
+            perror("Error adding socket to epoll");
+            return 1;
         }
-        else
+    }
+
+    std::cout << "Servicing " << m_sockets.size() << " sockets from one epoll loop" << std::endl;
+
+    return 0;
+}
+
+void CanReceiver::setup_batch()
+{
+    m_frames.resize(m_options.batch_size);
+    m_addresses.resize(m_options.batch_size);
+    m_controls.resize(m_options.batch_size);
+    m_iovecs.resize(m_options.batch_size);
+    m_messages.resize(m_options.batch_size);
+
+    for (unsigned int i = 0; i < m_options.batch_size; i++)
+    {
+        m_iovecs[i].iov_base = &m_frames[i];
+        m_iovecs[i].iov_len = sizeof(canfd_frame);
+
+        std::memset(&m_messages[i], 0, sizeof(struct mmsghdr));
+        m_messages[i].msg_hdr.msg_name = &m_addresses[i];
+        m_messages[i].msg_hdr.msg_iov = &m_iovecs[i];
+        m_messages[i].msg_hdr.msg_iovlen = 1;
+        m_messages[i].msg_hdr.msg_control = m_controls[i].data;
+    }
+
+    std::cout << "Receiving up to " << m_options.batch_size << " frame(s) per syscall" << std::endl;
+}
+
+int CanReceiver::setup_capture()
+{
+    if (m_capture.open(m_options.capture_path, m_options.capture_capacity))
+    {
+        return 1;
+    }
+
+    for (const InterfaceCounter& interface : m_interfaces)
+    {
+        if (m_capture.add_interface(interface.ifindex, interface.name))
+        {
+            return 1;
+        }
+    }
+
+    m_is_capturing = true;
+    std::cout << "Capturing up to " << m_options.capture_capacity << " frame(s) to " << m_options.capture_path
+              << std::endl;
+
+    return 0;
+}
+
+int CanReceiver::setup_uring()
+{
+    // Room to queue a receive for every batch slot and every socket at once
+    if (m_uring.open(m_options.batch_size + static_cast<unsigned int>(m_sockets.size())))
+    {
+        return 1;
+    }
+
+    m_uring_message.msg_namelen = sizeof(struct sockaddr_can);
+    m_uring_message.msg_controllen = sizeof(ControlBuffer::data);
+
+    // A multishot receive lays out its header, the address, the control messages and the frame in each buffer
+    unsigned int buffer_size = sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_can) +
+                               sizeof(ControlBuffer::data) + CANFD_MTU;
+
+    if (m_uring.setup_buffers(URING_BUFFER_GROUP, URING_BUFFER_COUNT, buffer_size) == 0)
+    {
+        m_is_uring_multishot = true;
+        std::cout << "Receiving through io_uring, multishot receive into " << URING_BUFFER_COUNT
+                  << " provided buffers" << std::endl;
+        return 0;
+    }
+
+    if (errno != EINVAL)
+    {
+        perror("Error registering io_uring buffers");
+        return 1;
+    }
+
+    // Before Linux 5.19
+    m_is_uring_multishot = false;
+    std::cout << "Receiving through io_uring, " << m_options.batch_size << " receive(s) queued" << std::endl;
+
+    return 0;
+}
+
+void CanReceiver::prefault_buffers()
+{
+    // Touch every page the receive path writes, so the first frames do not take page faults
+    prefault(m_frames.data(), m_frames.size() * sizeof(canfd_frame));
+    prefault(m_controls.data(), m_controls.size() * sizeof(ControlBuffer));
+
+    if (m_is_capturing)
+    {
+        m_capture.prefault();
+    }
+}
+
+void CanReceiver::run()
+{
+    std::thread consumer {};
+    std::thread reporter {};
+
+    m_is_running = true;
+    m_is_reader_done = false;
+
+    m_dispatcher.compile();
+
+    // Keep signals on this thread so they interrupt the blocking receive
+    sigset_t all_signals;
+    sigset_t previous_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, &previous_signals);
+    if (m_ring)
+    {
+        consumer = std::thread {&CanReceiver::consume_frames, this};
+    }
+    if (m_bus_statistics)
+    {
+        reporter = std::thread {&CanReceiver::report_bus_statistics, this};
+    }
+    pthread_sigmask(SIG_SETMASK, &previous_signals, nullptr);
+
+    // After starting the threads, so the reporter keeps the default scheduling
+    if (m_options.realtime.is_enabled())
+    {
+        apply_realtime(m_options.realtime, 0, "reader");
+    }
+
+    double cpu_start = cpu_seconds();
+
+    receive_frames();
+
+    m_is_reader_done = true;
+    if (consumer.joinable())
+    {
+        consumer.join();
+    }
+
+    m_is_running = false;
+    if (reporter.joinable())
+    {
+        reporter.join();
+    }
+
+    m_cpu_seconds = cpu_seconds() - cpu_start;
+
+    m_output.flush();
+
+    print_statistics();
+
+    if (m_is_capturing)
+    {
+        m_capture.close();
+        m_is_capturing = false;
+    }
+}
+
+void CanReceiver::receive_frames()
+{
+    if (!m_packet_rings.empty())
+    {
+        receive_packet_frames();
+        return;
+    }
+
+    if (m_uring.is_open())
+    {
+        receive_uring_frames();
+        return;
+    }
+
+    if (m_isotp.socket() >= 0)
+    {
+        receive_isotp_messages();
+        return;
+    }
+
+    if (m_j1939.socket() >= 0)
+    {
+        receive_j1939_messages();
+        return;
+    }
+
+    std::vector<struct epoll_event> events(m_sockets.size());
+
+    while (m_is_running)
+    {
+        // Without a processing thread the frames of the previous batch were printed on this one
+        if (!m_ring)
+        {
+            m_output.flush();
+            handle_report_request();
+        }
+
+        // A single socket blocks in recvmmsg() directly, saving the epoll_wait() call per batch
+        if (m_epoll < 0)
+        {
+            if (!receive_batch(m_sockets.front(), MSG_WAITFORONE))
+            {
+                break;
+            }
+            continue;
+        }
+
+        int ready = epoll_wait(m_epoll, events.data(), static_cast<int>(events.size()), -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            perror("Error waiting for CAN sockets");
+            break;
+        }
+
+        for (int i = 0; i < ready && m_is_running; i++)
+        {
+            if (!receive_batch(m_sockets[events[i].data.u32], MSG_DONTWAIT))
+            {
+                m_is_running = false;
+            }
+        }
+    }
+}
+
+bool CanReceiver::receive_batch(InterfaceSocket& can_socket, int flags)
+{
+    // The kernel shrinks msg_namelen and msg_controllen to what it wrote, restore the full space for every call
+    for (struct mmsghdr& message : m_messages)
+    {
+        message.msg_hdr.msg_namelen = sizeof(struct sockaddr_can);
+        message.msg_hdr.msg_controllen = sizeof(ControlBuffer::data);
+    }
+
+    // Blocking: wait for at least one frame, then also take whatever is already queued
+    int count = recvmmsg(can_socket.socket, m_messages.data(), m_options.batch_size, flags, nullptr);
+
+    if (count < 0)
+    {
+        if (errno == EINTR || errno == EAGAIN)
+        {
+            return true;
+        }
+
+        perror("Error reading CAN frame");
+        return false;
+    }
+
+    m_syscall_count++;
+
+    uint32_t drop_counter = can_socket.drop_counter;
+    for (int i = 0; i < count; i++)
+    {
+        ReceivedFrame received {m_frames[i], m_messages[i].msg_len == CANFD_MTU, {}, false,
+                                m_addresses[i].can_ifindex};
+
+        if (!received.is_fd && m_messages[i].msg_len != CAN_MTU)
+        {
+            std::cout << "Warning: incomplete CAN frame received" << std::endl;
+            continue;
+        }
+
+        read_control_messages(m_messages[i].msg_hdr, received, drop_counter);
+
+        deliver_frame(received);
+        if (!m_is_running)
+        {
+            break;
+        }
+    }
+
+    if (drop_counter != can_socket.drop_counter)
+    {
+        count_queue_drops(can_socket, drop_counter);
+    }
+
+    return true;
+}
+
+void CanReceiver::count_queue_drops(InterfaceSocket& can_socket, uint32_t drop_counter)
+{
+    // The counter is the socket's total, unsigned subtraction also covers it wrapping around
+    uint32_t dropped = drop_counter - can_socket.drop_counter;
+    can_socket.drop_counter = drop_counter;
+    m_queue_drop_count += dropped;
+    m_interval_queue_drop_count += dropped;
+
+    // At most one warning per second, with the drops since the previous one
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    uint64_t now_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+    if (now_ns - m_last_drop_warning_ns < 1'000'000'000)
+    {
+        return;
+    }
+
+    std::cout << "Warning: receive queue of " << can_socket.name << " dropped " << m_interval_queue_drop_count
+              << " frame(s)";
+    if (m_last_drop_warning_ns != 0)
+    {
+        std::cout << " in the last " << (now_ns - m_last_drop_warning_ns) / 1e9 << " s";
+    }
+    std::cout << ", " << m_queue_drop_count << " in total. Raise --rcvbuf or --batch." << std::endl;
+
+    m_interval_queue_drop_count = 0;
+    m_last_drop_warning_ns = now_ns;
+}
+
+void CanReceiver::receive_uring_frames()
+{
+    for (uint32_t i = 0; i < (m_is_uring_multishot ? m_sockets.size() : m_options.batch_size); i++)
+    {
+        if (!(m_is_uring_multishot ? submit_multishot_receive(i) : submit_single_receive(i)))
+        {
+            return;
+        }
+    }
+
+    while (m_is_running)
+    {
+        if (!m_ring)
+        {
+            m_output.flush();
+            handle_report_request();
+        }
+
+        // Hands over the receives queued since the last call and sleeps until a completion arrives
+        if (m_uring.submit(1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            perror("Error waiting for io_uring completions");
+            break;
+        }
+
+        m_syscall_count++;
+
+        m_uring.drain([this](const struct io_uring_cqe& cqe) {
+            if (cqe.user_data & URING_SINGLE_RECEIVE)
+            {
+                handle_single_completion(cqe);
+            }
+            else
+            {
+                handle_multishot_completion(cqe);
+            }
+        });
+    }
+}
+
+bool CanReceiver::submit_multishot_receive(uint32_t socket_index)
+{
+    struct io_uring_sqe* sqe = m_uring.get_sqe();
+    if (sqe == nullptr)
+    {
+        std::cerr << "Error queuing receive: io_uring submission queue full" << std::endl;
+        return false;
+    }
+
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = m_sockets[socket_index].socket;
+    sqe->addr = reinterpret_cast<uint64_t>(&m_uring_message);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    sqe->user_data = socket_index;
+
+    return true;
+}
+
+bool CanReceiver::submit_single_receive(uint32_t slot)
+{
+    struct io_uring_sqe* sqe = m_uring.get_sqe();
+    if (sqe == nullptr)
+    {
+        std::cerr << "Error queuing receive: io_uring submission queue full" << std::endl;
+        return false;
+    }
+
+    // The kernel shrinks msg_namelen and msg_controllen to what it wrote
+    struct msghdr& message = m_messages[slot].msg_hdr;
+    message.msg_namelen = sizeof(struct sockaddr_can);
+    message.msg_controllen = sizeof(ControlBuffer::data);
+
+    // Slots are spread over the sockets, each keeps at least one receive queued
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = m_sockets[slot % m_sockets.size()].socket;
+    sqe->addr = reinterpret_cast<uint64_t>(&message);
+    sqe->len = 1;
+    sqe->user_data = URING_SINGLE_RECEIVE | slot;
+
+    return true;
+}
+
+void CanReceiver::handle_multishot_completion(const struct io_uring_cqe& cqe)
+{
+    uint32_t socket_index = static_cast<uint32_t>(cqe.user_data);
+    InterfaceSocket& can_socket = m_sockets[socket_index];
+
+    if (cqe.res == -EINVAL && m_is_uring_multishot)
+    {
+        // Linux 5.19 has buffer rings but no multishot receive, switch to single receives into the batch slots
+        std::cout << "Warning: Kernel has no multishot receive, keeping " << m_options.batch_size
+                  << " receive(s) queued instead" << std::endl;
+        m_is_uring_multishot = false;
+        for (uint32_t slot = 0; slot < m_options.batch_size; slot++)
+        {
+            submit_single_receive(slot);
+        }
+        return;
+    }
+
+    if (cqe.res < 0)
+    {
+        // Out of buffers or already switched to single receives, frames wait in the socket queue meanwhile
+        if (cqe.res != -ENOBUFS && cqe.res != -EINVAL)
+        {
+            errno = -cqe.res;
+            perror("Error reading CAN frame");
+            m_is_running = false;
+            return;
+        }
+    }
+    else
+    {
+        uint16_t buffer_id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        const uint8_t* buffer = m_uring.buffer(buffer_id);
+
+        // Name and control areas have the size asked for in m_uring_message, whatever the kernel filled in
+        auto* header = reinterpret_cast<const struct io_uring_recvmsg_out*>(buffer);
+        const uint8_t* name = buffer + sizeof(struct io_uring_recvmsg_out);
+        const uint8_t* control = name + m_uring_message.msg_namelen;
+        const uint8_t* payload = control + m_uring_message.msg_controllen;
+
+        if (header->payloadlen != CAN_MTU && header->payloadlen != CANFD_MTU)
+        {
+            std::cout << "Warning: incomplete CAN frame received" << std::endl;
+        }
+        else if (m_is_running)
+        {
+            struct sockaddr_can address {};
+            std::memcpy(&address, name, std::min<size_t>(header->namelen, sizeof(address)));
+
+            ReceivedFrame received {{}, header->payloadlen == CANFD_MTU, {}, false, address.can_ifindex};
+            std::memcpy(&received.frame, payload, header->payloadlen);
+
+            struct msghdr message {};
+            message.msg_control = const_cast<uint8_t*>(control);
+            message.msg_controllen = header->controllen;
+
+            uint32_t drop_counter = can_socket.drop_counter;
+            read_control_messages(message, received, drop_counter);
+            deliver_frame(received);
+
+            if (drop_counter != can_socket.drop_counter)
+            {
+                count_queue_drops(can_socket, drop_counter);
+            }
+        }
+
+        m_uring.recycle_buffer(buffer_id);
+    }
+
+    // The kernel ends a multishot receive when it runs out of buffers or fails, start a new one
+    if (!(cqe.flags & IORING_CQE_F_MORE) && m_is_running && m_is_uring_multishot)
+    {
+        submit_multishot_receive(socket_index);
+    }
+}
+
+void CanReceiver::handle_single_completion(const struct io_uring_cqe& cqe)
+{
+    uint32_t slot = static_cast<uint32_t>(cqe.user_data);
+    InterfaceSocket& can_socket = m_sockets[slot % m_sockets.size()];
+
+    if (cqe.res < 0)
+    {
+        if (cqe.res != -EINTR && cqe.res != -EAGAIN)
+        {
+            errno = -cqe.res;
+            perror("Error reading CAN frame");
+            m_is_running = false;
+            return;
+        }
+    }
+    else if (m_is_running)
+    {
+        ReceivedFrame received {m_frames[slot], cqe.res == CANFD_MTU, {}, false, m_addresses[slot].can_ifindex};
+
+        if (!received.is_fd && cqe.res != CAN_MTU)
+        {
+            std::cout << "Warning: incomplete CAN frame received" << std::endl;
+        }
+        else
+        {
+            uint32_t drop_counter = can_socket.drop_counter;
+            read_control_messages(m_messages[slot].msg_hdr, received, drop_counter);
+            deliver_frame(received);
+
+            if (drop_counter != can_socket.drop_counter)
+            {
+                count_queue_drops(can_socket, drop_counter);
+            }
+        }
+    }
+
+    if (m_is_running)
+    {
+        submit_single_receive(slot);
+    }
+}
+
+void CanReceiver::receive_packet_frames()
+{
+    std::vector<struct pollfd> fds;
+    for (const std::unique_ptr<PacketRing>& ring : m_packet_rings)
+    {
+        fds.push_back({ring->socket(), POLLIN | POLLERR, 0});
+    }
+
+    while (m_is_running)
+    {
+        if (!m_ring)
+        {
+            m_output.flush();
+            handle_report_request();
+        }
+
+        // Take every block already handed over before sleeping again, one wakeup can cover many blocks
+        for (std::unique_ptr<PacketRing>& ring : m_packet_rings)
+        {
+            int ifindex = ring->ifindex();
+            ring->drain([this, ifindex](const uint8_t* data, uint32_t length, const struct timespec& timestamp) {
+                receive_packet_frame(data, length, timestamp, ifindex);
+            });
+        }
+
+        if (!m_is_running)
+        {
+            break;
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            perror("Error waiting for packet rings");
+            break;
+        }
+
+        m_syscall_count++;
+    }
+
+    for (std::unique_ptr<PacketRing>& ring : m_packet_rings)
+    {
+        m_packet_drop_count += ring->read_drop_count();
+    }
+}
+
+void CanReceiver::receive_packet_frame(const uint8_t* data, uint32_t length, const struct timespec& timestamp,
+                                       int ifindex)
+{
+    // The rest of the block holding the END message is not processed
+    if (!m_is_running)
+    {
+        return;
+    }
+
+    ReceivedFrame received {{}, length == CANFD_MTU, timestamp, false, ifindex};
+    std::memcpy(&received.frame, data, length);
+
+    if (!matches_filters(received.frame.can_id))
+    {
+        return;
+    }
+
+    deliver_frame(received);
+}
+
+bool CanReceiver::matches_filters(canid_t can_id) const
+{
+    // Same rules as the CAN_RAW socket: error frames only by error class, then any (or all joined) filters
+    if (can_id & CAN_ERR_FLAG)
+    {
+        return (can_id & m_options.error_mask & CAN_ERR_MASK) != 0;
+    }
+
+    if (m_options.filters.empty())
+    {
+        return true;
+    }
+
+    for (const can_filter& filter : m_options.filters)
+    {
+        canid_t filter_id = filter.can_id & ~CAN_INV_FILTER;
+        bool is_match = (can_id & filter.can_mask) == (filter_id & filter.can_mask);
+
+        if (filter.can_id & CAN_INV_FILTER)
+        {
+            is_match = !is_match;
+        }
+
+        if (is_match != m_options.join_filters)
+        {
+            return is_match;
+        }
+    }
+
+    return m_options.join_filters;
+}
+
+void CanReceiver::receive_isotp_messages()
+{
+    // One byte more than the largest message, so an oversized one shows up as truncated
+    std::vector<uint8_t> buffer(ISOTP_MAX_PAYLOAD + 1);
+    struct timespec first {};
+    struct timespec last {};
+
+    while (m_is_running)
+    {
+        handle_report_request();
+
+        ssize_t length = m_isotp.receive(buffer.data(), buffer.size());
+        if (length < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            // Transfer errors such as a consecutive frame timeout only lose the current message, anything else such
+            // as the interface going down would fail every further call
+            perror("Error receiving ISO-TP message");
+            if (errno == ECOMM || errno == EILSEQ || errno == ETIMEDOUT || errno == EBADMSG)
+            {
+                continue;
+            }
+            break;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &last);
+        if (m_frame_count == 0)
+        {
+            first = last;
+        }
+
+        m_syscall_count++;
+        m_frame_count++;
+        m_isotp_byte_count += static_cast<uint64_t>(length);
+        m_interfaces.front().frame_count++;
+
+        if (length == 3 && std::memcmp(buffer.data(), "END", 3) == 0)
+        {
+            std::cout << "Received END message, stopping receiver" << std::endl;
+            break;
+        }
+
+        print_isotp_message(buffer.data(), static_cast<size_t>(length));
+    }
+
+    m_isotp_seconds = static_cast<double>(last.tv_sec - first.tv_sec) + (last.tv_nsec - first.tv_nsec) / 1e9;
+}
+
+void CanReceiver::print_isotp_message(const uint8_t* data, size_t length) const
+{
+    // Messages can be kilobytes long, only the start is printed
+    constexpr size_t PRINT_LENGTH = 16;
+
+    std::cout << "Received ISO-TP message: LEN=" << length << ", Data=";
+    for (size_t i = 0; i < length && i < PRINT_LENGTH; i++)
+    {
+        printf("%02X ", data[i]);
+    }
+    std::cout << (length > PRINT_LENGTH ? "..." : "") << std::endl;
+}
+
+void CanReceiver::receive_j1939_messages()
+{
+    std::vector<uint8_t> buffer(J1939_MAX_PAYLOAD);
+    struct pollfd fds[2] {{m_j1939.socket(), POLLIN, 0}, {m_j1939.claim_socket(), POLLIN, 0}};
+    nfds_t fd_count = m_j1939.claim_socket() >= 0 ? 2 : 1;
+
+    while (m_is_running)
+    {
+        handle_report_request();
+
+        if (poll(fds, fd_count, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            perror("Error waiting for J1939 messages");
+            break;
+        }
+
+        m_syscall_count++;
+
+        // Answer requests and contending claims, losing the address opens a new claim socket
+        if (fd_count > 1 && (fds[1].revents & POLLIN))
+        {
+            m_j1939.service_claims();
+            fds[1].fd = m_j1939.claim_socket();
+        }
+
+        if (!(fds[0].revents & POLLIN))
+        {
+            continue;
+        }
+
+        J1939Message message;
+        ssize_t length;
+        while (m_is_running &&
+               (length = m_j1939.receive(buffer.data(), buffer.size(), message, MSG_DONTWAIT)) >= 0)
+        {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+
+            m_pgn_statistics.add(message.pgn, static_cast<size_t>(length),
+                                 static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec);
+            m_frame_count++;
+            m_interfaces.front().frame_count++;
+
+            print_j1939_message(message, buffer.data(), static_cast<size_t>(length));
+        }
+
+        if (m_is_running && errno != EAGAIN && errno != EINTR)
+        {
+            // Aborted transport sessions are reported here, the next message is unaffected
+            perror("Error receiving J1939 message");
+        }
+    }
+}
+
+void CanReceiver::print_j1939_message(const J1939Message& message, const uint8_t* data, size_t length) const
+{
+    constexpr size_t PRINT_LENGTH = 16;
+
+    printf("Received J1939: PGN=0x%05X SA=0x%02X DA=0x%02X PRIO=%u LEN=%zu Data=", message.pgn,
+           message.source_address, message.destination_address, message.priority, length);
+    for (size_t i = 0; i < length && i < PRINT_LENGTH; i++)
+    {
+        printf("%02X ", data[i]);
+    }
+    printf("%s\n", length > PRINT_LENGTH ? "..." : "");
+}
+
+void CanReceiver::deliver_frame(const ReceivedFrame& received)
+{
+    m_frame_count++;
+    count_interface_frame(received.ifindex);
+    dispatch_frame(received);
+
+    if (is_end_message(received.frame))
+    {
+        if (!m_ring)
+        {
+            m_output.flush();
+        }
+        std::cout << "Received END message, stopping receiver" << std::endl;
+        m_is_running = false;
+    }
+}
+
+void CanReceiver::count_interface_frame(int ifindex)
+{
+    for (InterfaceCounter& interface : m_interfaces)
+    {
+        if (interface.ifindex == ifindex)
+        {
+            interface.frame_count++;
+            return;
+        }
+    }
+
+    // Interfaces created after startup on an "any" socket
+    m_unknown_interface_count++;
+}
+
+const char* CanReceiver::interface_name(int ifindex) const
+{
+    for (const InterfaceCounter& interface : m_interfaces)
+    {
+        if (interface.ifindex == ifindex)
+        {
+            return interface.name.c_str();
+        }
+    }
+
+    return "unknown";
+}
+
+void CanReceiver::dispatch_frame(const ReceivedFrame& received)
+{
+    if (!m_ring)
+    {
+        process_frame(received);
+        return;
+    }
+
+    // Never block the reader, the kernel queue would overflow instead
+    if (!m_ring->push(received))
+    {
+        m_ring_drop_count++;
+    }
+}
+
+void CanReceiver::consume_frames()
+{
+    ReceivedFrame received;
+    unsigned int idle_count = 0;
+
+    if (m_options.realtime.is_enabled())
+    {
+        apply_realtime(m_options.realtime, 1, "processing");
+    }
+
+    while (true)
+    {
+        handle_report_request();
+
+        if (m_ring->pop(received))
+        {
+            idle_count = 0;
+            process_frame(received);
+            continue;
+        }
+
+        // The reader may have pushed its last frames right before finishing, drain them before leaving
+        if (m_is_reader_done)
+        {
+            if (m_ring->pop(received))
+            {
+                process_frame(received);
+                continue;
+            }
+            m_output.flush();
+            break;
+        }
+
+        // The ring ran empty, write out what the burst printed
+        if (idle_count == 0)
+        {
+            m_output.flush();
+        }
+
+        // Spin briefly for bursts, then back off to avoid burning a core on an idle bus
+        if (++idle_count < 64)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+void CanReceiver::stop()
+{
+    m_is_running = false;
+}
+
+void CanReceiver::request_report()
+{
+    m_is_report_requested = true;
+}
+
+int CanReceiver::add_handler(canid_t can_id, FrameHandler handler)
+{
+    return m_dispatcher.add(can_id, std::move(handler));
+}
+
+int CanReceiver::add_handler(canid_t can_id, canid_t mask, FrameHandler handler)
+{
+    return m_dispatcher.add(can_id, mask, std::move(handler));
+}
+
+void CanReceiver::handle_report_request()
+{
+    if (!m_is_report_requested.exchange(false, std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    m_output.flush();
+
+    if (m_j1939.socket() >= 0)
+    {
+        m_pgn_statistics.report(std::cout);
+    }
+    else
+    {
+        m_histogram.report(std::cout);
+    }
+}
+
+void CanReceiver::report_bus_statistics()
+{
+    auto interval = std::chrono::milliseconds(m_options.statistics_interval_ms);
+    auto deadline = std::chrono::steady_clock::now() + interval;
+
+    while (m_is_running)
+    {
+        // Sleep in short steps so a stopping receiver is not kept waiting for a whole interval
+        auto now = std::chrono::steady_clock::now();
+        if (now < deadline)
+        {
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(deadline - now,
+                                                                                       std::chrono::milliseconds(100)));
+            continue;
+        }
+
+        m_bus_statistics->report(std::cout, m_options.statistics_format);
+        deadline += interval;
+    }
+}
+
+void CanReceiver::print_statistics() const
+{
+    double average = m_syscall_count ? static_cast<double>(m_frame_count) / m_syscall_count : 0.0;
+
+    std::cout << "Received " << m_frame_count << " frame(s) in " << m_syscall_count << " syscall(s), average "
+              << average << " frame(s) per syscall" << std::endl;
+
+    std::cout << "CPU time " << m_cpu_seconds << " s";
+    if (m_frame_count > 0)
+    {
+        std::cout << ", " << m_cpu_seconds * 1e9 / static_cast<double>(m_frame_count) << " ns per frame";
+    }
+    std::cout << std::endl;
+
+    if (!m_packet_rings.empty())
+    {
+        std::cout << "Packet rings dropped " << m_packet_drop_count << " frame(s)" << std::endl;
+    }
+    else if (!m_sockets.empty())
+    {
+        std::cout << "Receive queues dropped " << m_queue_drop_count << " frame(s)" << std::endl;
+    }
+
+    if (m_isotp.socket() >= 0)
+    {
+        // Throughput between the first and the last message, the END message included
+        std::cout << "Received " << m_isotp_byte_count << " ISO-TP payload byte(s) in " << m_isotp_seconds << " s";
+        if (m_isotp_seconds > 0)
+        {
+            std::cout << ", " << m_isotp_byte_count / m_isotp_seconds / 1000 << " KB/s";
+        }
+        std::cout << std::endl;
+    }
+
+    if (m_interfaces.size() > 1 || m_unknown_interface_count > 0)
+    {
+        for (const InterfaceCounter& interface : m_interfaces)
+        {
+            std::cout << "  " << interface.name << " (index " << interface.ifindex << "): " << interface.frame_count
+                      << " frame(s)" << std::endl;
+        }
+
+        if (m_unknown_interface_count > 0)
+        {
+            std::cout << "  other interfaces: " << m_unknown_interface_count << " frame(s)" << std::endl;
+        }
+    }
+
+    if (m_ring)
+    {
+        std::cout << "Ring: capacity " << m_ring->capacity() << ", occupancy " << m_ring->occupancy()
+                  << ", high-water " << m_ring->high_water() << ", dropped " << m_ring_drop_count << std::endl;
+    }
+
+    if (m_is_capturing)
+    {
+        std::cout << "Captured " << m_capture.record_count() << " frame(s) to " << m_options.capture_path
+                  << ", dropped " << m_capture.drop_count() << " (file full)" << std::endl;
+    }
+
+    if (m_bus_statistics)
+    {
+        m_bus_statistics->report(std::cout, m_options.statistics_format);
+    }
+
+    // The processing thread has been joined, the histogram is safe to read
+    if (m_j1939.socket() >= 0)
+    {
+        m_pgn_statistics.report(std::cout);
+    }
+    else
+    {
+        m_histogram.report(std::cout);
+    }
+}
+
+void CanReceiver::process_frame(const ReceivedFrame& received)
+{
+    // Error frames have no ID to dispatch on, they only go through the receiver's own stages
+    if (received.frame.can_id & CAN_ERR_FLAG)
+    {
+        record_arrival(received);
+        output_frame(received);
+        return;
+    }
+
+    m_dispatcher.dispatch(received);
+}
+
+void CanReceiver::record_arrival(const ReceivedFrame& received)
+{
+    if (received.timestamp.tv_sec != 0 || received.timestamp.tv_nsec != 0)
+    {
+        m_histogram.add(received.frame.can_id, received.timestamp);
+    }
+
+    if (m_bus_statistics)
+    {
+        struct timespec timestamp = received.timestamp;
+        if (timestamp.tv_sec == 0 && timestamp.tv_nsec == 0)
+        {
+            clock_gettime(CLOCK_REALTIME, &timestamp);
+        }
+        m_bus_statistics->add(received.frame, received.is_fd,
+                              static_cast<uint64_t>(timestamp.tv_sec) * 1'000'000'000 + timestamp.tv_nsec);
+    }
+}
+
+void CanReceiver::output_frame(const ReceivedFrame& received)
+{
+    if (m_is_capturing)
+    {
+        capture_frame(received);
+    }
+    else if (!m_options.is_quiet && ++m_frames_since_print >= m_options.print_every)
+    {
+        m_frames_since_print = 0;
+        print_frame(received);
+    }
+}
+
+void CanReceiver::capture_frame(const ReceivedFrame& received)
+{
+    CaptureRecord record;
+
+    record.timestamp_ns =
+        static_cast<uint64_t>(received.timestamp.tv_sec) * 1'000'000'000 + received.timestamp.tv_nsec;
+    record.can_id = received.frame.can_id;
+    record.ifindex = static_cast<uint32_t>(received.ifindex);
+    record.len = received.frame.len;
+    record.fd_flags = received.frame.flags;
+    record.record_flags = (received.is_fd ? CAPTURE_FLAG_FD : 0) |
+                          (received.is_hw_timestamp ? CAPTURE_FLAG_HW_TIMESTAMP : 0);
+    record.reserved0 = 0;
+    std::memcpy(record.data, received.frame.data, CANFD_MAX_DLEN);
+    record.reserved1 = 0;
+
+    m_capture.append(record);
+}
+
+void CanReceiver::print_frame(const ReceivedFrame& received)
+{
+    const canfd_frame& frame = received.frame;
+
+    if (received.timestamp.tv_sec != 0 || received.timestamp.tv_nsec != 0)
+    {
+        m_output.append('(');
+        m_output.append_decimal(static_cast<uint64_t>(received.timestamp.tv_sec));
+        m_output.append('.');
+        m_output.append_decimal(static_cast<uint64_t>(received.timestamp.tv_nsec / 1000), 6);
+        m_output.append(") ");
+    }
+
+    if (m_interfaces.size() > 1)
+    {
+        m_output.append(interface_name(received.ifindex));
+        m_output.append(' ');
+    }
+
+    m_output.append("Received: ID=0x");
+    m_output.append_hex(frame.can_id);
+
+    if (received.is_fd)
+    {
+        m_output.append((frame.flags & CANFD_BRS) ? ", FD+BRS, LEN=" : ", FD, LEN=");
+    }
+    else
+    {
+        m_output.append(", DLC=");
+    }
+    m_output.append_decimal(frame.len);
+    m_output.append(", Data=");
+
+    // Print hex data
+    for (int i = 0; i < frame.len; i++)
+    {
+        m_output.append_hex_byte(frame.data[i]);
+        m_output.append(' ');
+    }
+
+    // Print as string if printable
+    m_output.append("('");
+    for (int i = 0; i < frame.len; i++)
+    {
+        bool is_printable = frame.data[i] >= 32 && frame.data[i] <= 126;
+        m_output.append(is_printable ? static_cast<char>(frame.data[i]) : '.');
+    }
+    m_output.append("')\n");
+
+    if (m_dbc.message_count() > 0)
+    {
+        print_signals(frame);
+    }
+}
+
+void CanReceiver::print_signals(const canfd_frame& frame)
+{
+    const DbcMessage* message = m_dbc.find(frame.can_id);
+    if (message == nullptr)
+    {
+        return;
+    }
+
+    m_dbc.decode(*message, frame, m_signal_values.data());
+
+    for (size_t i = 0; i < message->signals.size(); i++)
+    {
+        // Multiplexed signals absent from this frame decode to NaN
+        if (std::isnan(m_signal_values[i]))
+        {
+            continue;
+        }
+
+        const DbcSignal& signal = message->signals[i];
+        m_output.append("    ");
+        m_output.append(message->name);
+        m_output.append('.');
+        m_output.append(signal.name);
+        m_output.append(" = ");
+        m_output.append_double(m_signal_values[i]);
+        if (!signal.unit.empty())
         {
-            std::cout << ".";
+            m_output.append(' ');
+            m_output.append(signal.unit);
         }
+        m_output.append('\n');
     }
-    std::cout << "')" << std::endl;
 }
 
-bool CanReceiver::is_end_message(const can_frame& frame)
+bool CanReceiver::is_end_message(const canfd_frame& frame)
 {
-    return (frame.can_id == 0x124 && frame.can_dlc >= 3 &&
+    return (frame.can_id == 0x124 && frame.len >= 3 &&
             std::strncmp(reinterpret_cast<const char*>(frame.data), "END", 3) == 0);
 }
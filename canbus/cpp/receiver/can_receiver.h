@@ -18,30 +18,230 @@
 #ifndef CAN_RECEIVER_H
 #define CAN_RECEIVER_H
 
+#include "arrival_histogram.h"
+#include "bus_statistics.h"
+#include "can_capture.h"
+#include "dbc_database.h"
+#include "frame_dispatcher.h"
+#include "hw_timestamp.h"
+#include "isotp_socket.h"
+#include "j1939_socket.h"
+#include "output_buffer.h"
+#include "packet_ring.h"
+#include "pgn_statistics.h"
+#include "raw_socket.h"
+#include "realtime.h"
+#include "spsc_ring.h"
+#include "uring_queue.h"
 #include <linux/can.h>
 #include <linux/can/raw.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <sys/socket.h>
+#include <vector>
+
+struct CanReceiverOptions
+{
+    unsigned int batch_size {1}; // Frames received per recvmmsg() call
+
+    // Kernel-side filters installed with CAN_RAW_FILTER, frames matching none of them are dropped before they are
+    // copied to userspace. An empty list receives everything. Set CAN_INV_FILTER in can_id to invert a filter.
+    std::vector<can_filter> filters {};
+    bool join_filters {false};   // Frame must match all filters instead of any (CAN_RAW_JOIN_FILTERS)
+    can_err_mask_t error_mask {0}; // Error classes delivered as error frames (CAN_RAW_ERR_FILTER)
+
+    // Frames are handed from the socket reader thread to a processing thread through a ring of this many slots,
+    // so slow frame handlers do not stall socket draining. 0 processes frames inline on the reader thread.
+    size_t ring_capacity {1024};
+
+    // Socket receive buffer size in bytes (SO_RCVBUF), 0 keeps the system default. Frames arriving while it is
+    // full are dropped by the kernel, they are counted through SO_RXQ_OVFL and reported once per second.
+    int receive_buffer_size {0};
+
+    // Switch the interfaces to timestamping every received frame in hardware (SIOCSHWTSTAMP). This changes the
+    // interface for all its users and needs CAP_NET_ADMIN, the previous setting is restored on exit. Without it
+    // hardware timestamps are only delivered when the interface already has them on.
+    bool use_hw_timestamps {false};
+
+    // Append frames to a memory-mapped binary capture file instead of printing them
+    std::string capture_path {};
+    uint64_t capture_capacity {1'000'000}; // Records preallocated in the capture file
+
+    // Print nothing per frame, or only every print_every-th frame. Printing caps the receive rate long before
+    // the socket does.
+    bool is_quiet {false};
+    unsigned int print_every {1};
+
+    // Decode the signals of printed frames with the messages of this DBC file
+    std::string dbc_path {};
+
+    // Per-ID bus statistics printed every statistics_interval_ms by a separate thread, 0 disables them. The bus
+    // load estimate assumes bitrate, and data_bitrate for the data phase of CAN FD frames with BRS.
+    unsigned int statistics_interval_ms {0};
+    StatisticsFormat statistics_format {StatisticsFormat::Table};
+    uint32_t bitrate {500'000};
+    uint32_t data_bitrate {0};
+
+    // Receive through an AF_PACKET TPACKET_V3 ring mapped into userspace instead of CAN_RAW sockets. The kernel
+    // fills whole blocks and wakes the reader once per block, at the cost of up to packet_block_timeout_ms extra
+    // latency. CAN_RAW filters do not apply to packet sockets, the filters above are then matched in userspace.
+    bool use_packet_mmap {false};
+    unsigned int packet_block_timeout_ms {4};
+
+    // Receive through io_uring instead of blocking recvmmsg() calls. Each socket gets one multishot receive that
+    // fills buffers from a provided buffer ring, on kernels before 6.0 batch_size single receives are kept queued.
+    bool use_io_uring {false};
+
+    // Receive complete ISO-TP messages on a single interface instead of frames. Block size and STmin are what the
+    // receiver asks the sender for in its flow control frames.
+    bool use_isotp {false};
+    IsoTpOptions isotp {};
+
+    // Receive complete J1939 messages on a single interface, transport protocol sessions reassembled by the kernel
+    bool use_j1939 {false};
+    J1939Options j1939 {};
+
+    // Scheduling, CPU affinity and memory locking of the reader (CPU index 0) and processing (index 1) threads.
+    // The statistics reporter keeps the default scheduling.
+    RealtimeOptions realtime {};
+};
 
 class CanReceiver
 {
   public:
-    CanReceiver(std::string_view interface_name);
+    // Receives from all given interfaces on one thread. "any" binds a single socket to every CAN interface.
+    CanReceiver(const std::vector<std::string>& interface_names, const CanReceiverOptions& options = {});
     ~CanReceiver();
 
+    CanReceiver(const CanReceiver&) = delete;
+    CanReceiver& operator=(const CanReceiver&) = delete;
+
     int initialize();
     void run();
     void stop();
 
+    // Async-signal-safe, the report is printed by the thread processing frames
+    void request_report();
+
+    // Runs handler for every frame matching can_id, or (frame_id & mask) == (can_id & mask), on the thread
+    // processing frames. The receiver's own stages are handlers too: the handler runs after the frame is counted
+    // in the statistics and before it is printed or captured. Register before initialize(). See FrameDispatcher.
+    int add_handler(canid_t can_id, FrameHandler handler);
+    int add_handler(canid_t can_id, canid_t mask, FrameHandler handler);
+
   private:
-    std::string m_interface_name {};
-    int m_socket {-1};
-    bool m_is_running {false};
-
-    int setup_socket();
-    int bind_socket();
-    void process_frame(const can_frame& frame);
-    void print_frame(const can_frame& frame);
-    bool is_end_message(const can_frame& frame);
+    // One bound socket, ifindex 0 when it receives from every interface
+    struct InterfaceSocket
+    {
+        std::string name;
+        int ifindex;
+        int socket;
+        uint32_t drop_counter; // Last SO_RXQ_OVFL value, frames the socket's receive queue has dropped
+    };
+
+    // Interfaces frames are expected from, with their per-interface counters
+    struct InterfaceCounter
+    {
+        std::string name;
+        int ifindex;
+        uint64_t frame_count;
+    };
+
+    std::vector<std::string> m_interface_names {};
+    CanReceiverOptions m_options {};
+    std::vector<InterfaceSocket> m_sockets {};
+    std::vector<HwTimestampConfig> m_hw_timestamps {}; // Interfaces switched to hardware timestamps, to restore
+    std::vector<std::unique_ptr<PacketRing>> m_packet_rings {};
+    std::vector<InterfaceCounter> m_interfaces {};
+    uint64_t m_unknown_interface_count {0};
+    int m_epoll {-1};
+    std::atomic<bool> m_is_running {false};
+    std::atomic<bool> m_is_reader_done {false};
+    std::atomic<bool> m_is_report_requested {false};
+
+    // Preallocated receive batch for recvmmsg()
+    std::vector<canfd_frame> m_frames {};
+    std::vector<struct sockaddr_can> m_addresses {};
+    std::vector<ControlBuffer> m_controls {};
+    std::vector<struct iovec> m_iovecs {};
+    std::vector<struct mmsghdr> m_messages {};
+
+    UringQueue m_uring {};
+    bool m_is_uring_multishot {false};
+    struct msghdr m_uring_message {}; // Name and control space every multishot receive lays out in its buffer
+
+    std::unique_ptr<SpscRing<ReceivedFrame>> m_ring {};
+    ArrivalHistogram m_histogram {};
+    CaptureWriter m_capture {};
+    bool m_is_capturing {false};
+
+    uint64_t m_frame_count {0};
+    uint64_t m_syscall_count {0};
+    uint64_t m_ring_drop_count {0};
+    uint64_t m_packet_drop_count {0};
+    uint64_t m_queue_drop_count {0};          // Frames dropped by the sockets' receive queues
+    uint64_t m_interval_queue_drop_count {0}; // The same since the last drop warning
+    uint64_t m_last_drop_warning_ns {0};
+    IsoTpSocket m_isotp {};
+    uint64_t m_isotp_byte_count {0};
+    double m_isotp_seconds {0.0};
+    J1939Socket m_j1939 {};
+    PgnStatistics m_pgn_statistics {};
+    double m_cpu_seconds {0.0};
+    OutputBuffer m_output {};
+    uint64_t m_frames_since_print {0};
+    DbcDatabase m_dbc {};
+    std::vector<double> m_signal_values {};
+    std::unique_ptr<BusStatistics> m_bus_statistics {};
+    FrameDispatcher m_dispatcher {};
+
+    int open_interface(const std::string& name);
+    int open_packet_ring(const std::string& name);
+    int open_isotp();
+    int open_j1939();
+    int setup_socket(InterfaceSocket& can_socket);
+    void setup_receive_buffer(int socket);
+    int setup_filters(int socket);
+    int bind_socket(InterfaceSocket& can_socket);
+    int find_can_interfaces();
+    void setup_timestamping(int socket, const std::string& interface_name);
+    int setup_epoll();
+    void setup_batch();
+    int setup_capture();
+    int setup_uring();
+    void prefault_buffers();
+    void receive_frames();
+    bool receive_batch(InterfaceSocket& can_socket, int flags);
+    void count_queue_drops(InterfaceSocket& can_socket, uint32_t drop_counter);
+    void receive_uring_frames();
+    bool submit_multishot_receive(uint32_t socket_index);
+    bool submit_single_receive(uint32_t slot);
+    void handle_multishot_completion(const struct io_uring_cqe& cqe);
+    void handle_single_completion(const struct io_uring_cqe& cqe);
+    void receive_packet_frames();
+    void receive_packet_frame(const uint8_t* data, uint32_t length, const struct timespec& timestamp, int ifindex);
+    bool matches_filters(canid_t can_id) const;
+    void receive_isotp_messages();
+    void print_isotp_message(const uint8_t* data, size_t length) const;
+    void receive_j1939_messages();
+    void print_j1939_message(const J1939Message& message, const uint8_t* data, size_t length) const;
+    void count_interface_frame(int ifindex);
+    const char* interface_name(int ifindex) const;
+    void consume_frames();
+    void dispatch_frame(const ReceivedFrame& received);
+    void deliver_frame(const ReceivedFrame& received);
+    void handle_report_request();
+    void report_bus_statistics();
+    void print_statistics() const;
+    void process_frame(const ReceivedFrame& received);
+    void record_arrival(const ReceivedFrame& received);
+    void output_frame(const ReceivedFrame& received);
+    void capture_frame(const ReceivedFrame& received);
+    void print_frame(const ReceivedFrame& received);
+    void print_signals(const canfd_frame& frame);
+    bool is_end_message(const canfd_frame& frame);
 };
 
 #endif // CAN_RECEIVER_H
@@ -16,45 +16,485 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "can_receiver.h"
+#include "hex_parse.h"
+#include <cstdlib>
+#include <getopt.h>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <signal.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Global variables
+static std::unique_ptr<CanReceiver> g_receiver;
 
 void signal_handler([[maybe_unused]] int sig)
 {
     std::cout << "\nShutting down..." << std::endl;
-    exit(0);
+    if (g_receiver)
+    {
+        g_receiver->stop();
+    }
+}
+
+// Parses "ID:MASK" (pass matching frames) or "ID~MASK" (pass frames that do not match), both in hex.
+// IDs above 0x7FF are treated as extended, and the mask always covers the frame format so a standard
+// filter never matches an extended frame with the same numeric ID.
+bool parse_filter(const std::string& text, can_filter& filter)
+{
+    size_t separator = text.find_first_of(":~");
+    if (separator == std::string::npos || separator == 0 || separator == text.size() - 1)
+    {
+        return false;
+    }
+
+    try
+    {
+        size_t id_end;
+        size_t mask_end;
+        unsigned long id = std::stoul(text.substr(0, separator), &id_end, 16);
+        unsigned long mask = std::stoul(text.substr(separator + 1), &mask_end, 16);
+
+        if (id_end != separator || mask_end != text.size() - separator - 1 || id > CAN_EFF_MASK || mask > CAN_EFF_MASK)
+        {
+            return false;
+        }
+
+        filter.can_id = static_cast<canid_t>(id);
+        filter.can_mask = static_cast<canid_t>(mask) | CAN_EFF_FLAG;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+
+    if (filter.can_id > CAN_SFF_MASK)
+    {
+        filter.can_id |= CAN_EFF_FLAG;
+    }
+
+    if (text[separator] == '~')
+    {
+        filter.can_id |= CAN_INV_FILTER;
+    }
+
+    return true;
+}
+
+void report_handler([[maybe_unused]] int sig)
+{
+    if (g_receiver)
+    {
+        g_receiver->request_report();
+    }
+}
+
+// Parses "BPS" or "BPS:DATA_BPS", the nominal and CAN FD data phase bitrates
+bool parse_bitrate(const std::string& text, CanReceiverOptions& options)
+{
+    char* end;
+    unsigned long bitrate = std::strtoul(text.c_str(), &end, 10);
+    if (end == text.c_str() || bitrate == 0 || bitrate > 10'000'000)
+    {
+        return false;
+    }
+
+    options.bitrate = static_cast<uint32_t>(bitrate);
+    options.data_bitrate = 0;
+
+    if (*end == ':')
+    {
+        const char* data_text = end + 1;
+        unsigned long data_bitrate = std::strtoul(data_text, &end, 10);
+        if (end == data_text || data_bitrate == 0 || data_bitrate > 20'000'000)
+        {
+            return false;
+        }
+        options.data_bitrate = static_cast<uint32_t>(data_bitrate);
+    }
+
+    return *end == '\0';
 }
 
 void print_usage(std::string_view program_name)
 {
-    std::cout << "Usage: " << program_name << " [OPTIONS]" << std::endl;
+    std::cout << "Usage: " << program_name << " [OPTIONS] DEVICE..." << std::endl;
     std::cout << "Options:" << std::endl;
-    std::cout << "  DEVICE    CAN bus interface name" << std::endl;
-    std::cout << std::endl << "Example: " << program_name << " vcan0" << std::endl;
+    std::cout << "  DEVICE...             CAN bus interface names, or 'any' for all CAN interfaces" << std::endl;
+    std::cout << "  -b, --batch N         Receive up to N frames per syscall (default: 1)" << std::endl;
+    std::cout << "  -F, --filter ID:MASK  Only receive frames with (frame_id & MASK) == (ID & MASK), hex" << std::endl;
+    std::cout << "  -F, --filter ID~MASK  Only receive frames with (frame_id & MASK) != (ID & MASK), hex" << std::endl;
+    std::cout << "  -j, --join-filters    Frames must match all filters instead of any" << std::endl;
+    std::cout << "  -e, --error-mask MASK Receive error frames of the given classes (hex, CAN_ERR_* bits)" << std::endl;
+    std::cout << "  -r, --ring N          Processing thread queue size, 0 = inline (default: 1024)" << std::endl;
+    std::cout << "  -R, --rcvbuf BYTES    Socket receive buffer size (default: system default)" << std::endl;
+    std::cout << "  -H, --hw-timestamps   Timestamp frames in hardware, reconfigures the interface" << std::endl;
+    std::cout << "  -w, --write FILE      Capture frames to a binary file instead of printing them" << std::endl;
+    std::cout << "  -c, --capacity N      Frames preallocated in the capture file (default: 1000000)" << std::endl;
+    std::cout << "  -q, --quiet           Do not print received frames" << std::endl;
+    std::cout << "  -n, --every N         Only print every N-th received frame" << std::endl;
+    std::cout << "  -D, --dbc FILE        Decode the signals of printed frames with a DBC file" << std::endl;
+    std::cout << "  -s, --stats MS        Print per-ID statistics and the bus load every MS milliseconds" << std::endl;
+    std::cout << "  -o, --json            Print the statistics as one JSON object per line" << std::endl;
+    std::cout << "  -B, --bitrate BPS[:D] Bitrate for the bus load, D for the CAN FD data phase (default: 500000)"
+              << std::endl;
+    std::cout << "  -P, --packet-mmap     Receive through a memory-mapped AF_PACKET ring" << std::endl;
+    std::cout << "  -T, --block-timeout MS Packet ring block timeout in ms (default: 4)" << std::endl;
+    std::cout << "  -U, --io-uring        Receive through io_uring with multishot receives" << std::endl;
+    std::cout << "  -d, --duration S      Stop after S seconds" << std::endl;
+    std::cout << "  -S, --sched POLICY    Reader and processing thread scheduling: fifo:PRIO, rr:PRIO or other"
+              << std::endl;
+    std::cout << "  -a, --affinity CPUS   Pin the reader and processing threads to CPUS, e.g. 2 or 2,3" << std::endl;
+    std::cout << "  -L, --lock-memory     Lock memory and prefault the receive buffers" << std::endl;
+    std::cout << "  -i, --isotp TX:RX     Receive ISO-TP messages, hex IDs this side sends and receives" << std::endl;
+    std::cout << "  -k, --block-size N    ISO-TP frames the sender may send per flow control (default: 0 = all)"
+              << std::endl;
+    std::cout << "  -m, --stmin US        ISO-TP gap requested between frames in us (default: 0)" << std::endl;
+    std::cout << "  -x, --padding HEX     Pad ISO-TP flow control frames to full length with byte HEX" << std::endl;
+    std::cout << "  -f, --fd              Use CAN FD frames for ISO-TP" << std::endl;
+    std::cout << "  -J, --j1939           Receive J1939 messages, including transport protocol sessions" << std::endl;
+    std::cout << "  -G, --pgn LIST        Only receive these comma separated hex PGNs" << std::endl;
+    std::cout << "  -N, --name HEX        J1939 NAME to claim an address with" << std::endl;
+    std::cout << "  -A, --address HEX     Preferred J1939 address with --name, otherwise a static address" << std::endl;
+    std::cout << "  -h, --help            Show this help message" << std::endl;
+    std::cout << std::endl << "Filters can be repeated. Include ID 0x124 to still see the END message." << std::endl;
+    std::cout << "Send SIGUSR1 to print the per-ID inter-arrival histogram, it is also printed on exit." << std::endl;
+    std::cout << "With --j1939 per-PGN message rates are printed instead." << std::endl;
+    std::cout << "The bus load counts worst-case bit stuffing, so it is an upper bound." << std::endl;
+    std::cout << "Real-time scheduling and memory locking need root or CAP_SYS_NICE and CAP_IPC_LOCK." << std::endl;
+    std::cout << std::endl << "Example: " << program_name << " -b 32 vcan0" << std::endl;
+    std::cout << "         " << program_name << " -F 120:7F0 -F 124:7FF vcan0" << std::endl;
+    std::cout << "         " << program_name << " -b 32 -R 4194304 -w vcan0.cap vcan0" << std::endl;
+    std::cout << "         " << program_name << " -b 32 can0 can1 vcan0" << std::endl;
+    std::cout << "         " << program_name << " -D vehicle.dbc vcan0" << std::endl;
+    std::cout << "         " << program_name << " -b 32 -n 1000 vcan0" << std::endl;
+    std::cout << "         " << program_name << " -w can0.cap -s 1000 -B 500000:2000000 can0" << std::endl;
+    std::cout << "         " << program_name << " -P -r 0 -d 10 vcan0" << std::endl;
+    std::cout << "         " << program_name << " -U -r 0 can0 can1" << std::endl;
+    std::cout << "         " << program_name << " -b 32 -q -S fifo:80 -a 2,3 -L can0" << std::endl;
+    std::cout << "         " << program_name << " -i 7E8:7E0 -k 8 -m 500 vcan0" << std::endl;
+    std::cout << "         " << program_name << " -J -G FEF1,FECA -N 8000000000000001 vcan0" << std::endl;
 }
 
 int main(int argc, char* argv[])
 {
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+    CanReceiverOptions options {};
+    int batch_size = 1;
+    int duration = 0;
+    int opt;
+    static struct option long_options[] = {{"batch", required_argument, 0, 'b'},
+                                           {"filter", required_argument, 0, 'F'},
+                                           {"join-filters", no_argument, 0, 'j'},
+                                           {"error-mask", required_argument, 0, 'e'},
+                                           {"ring", required_argument, 0, 'r'},
+                                           {"rcvbuf", required_argument, 0, 'R'},
+                                           {"hw-timestamps", no_argument, 0, 'H'},
+                                           {"write", required_argument, 0, 'w'},
+                                           {"capacity", required_argument, 0, 'c'},
+                                           {"quiet", no_argument, 0, 'q'},
+                                           {"every", required_argument, 0, 'n'},
+                                           {"dbc", required_argument, 0, 'D'},
+                                           {"stats", required_argument, 0, 's'},
+                                           {"json", no_argument, 0, 'o'},
+                                           {"bitrate", required_argument, 0, 'B'},
+                                           {"packet-mmap", no_argument, 0, 'P'},
+                                           {"block-timeout", required_argument, 0, 'T'},
+                                           {"io-uring", no_argument, 0, 'U'},
+                                           {"duration", required_argument, 0, 'd'},
+                                           {"sched", required_argument, 0, 'S'},
+                                           {"affinity", required_argument, 0, 'a'},
+                                           {"lock-memory", no_argument, 0, 'L'},
+                                           {"isotp", required_argument, 0, 'i'},
+                                           {"block-size", required_argument, 0, 'k'},
+                                           {"stmin", required_argument, 0, 'm'},
+                                           {"padding", required_argument, 0, 'x'},
+                                           {"fd", no_argument, 0, 'f'},
+                                           {"j1939", no_argument, 0, 'J'},
+                                           {"pgn", required_argument, 0, 'G'},
+                                           {"name", required_argument, 0, 'N'},
+                                           {"address", required_argument, 0, 'A'},
+                                           {"help", no_argument, 0, 'h'},
+                                           {0, 0, 0, 0}};
+
+    // Install without SA_RESTART so a blocking receive returns EINTR and the receiver can shut down cleanly
+    struct sigaction action {};
+    action.sa_handler = signal_handler;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGALRM, &action, nullptr);
 
-    if (argc < 2)
+    struct sigaction report_action {};
+    report_action.sa_handler = report_handler;
+    sigaction(SIGUSR1, &report_action, nullptr);
+
+    const char* short_options = "b:F:je:r:R:Hw:c:qn:D:s:oB:PT:Ud:S:a:Li:k:m:x:fJG:N:A:h";
+    while ((opt = getopt_long(argc, argv, short_options, long_options, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            batch_size = std::atoi(optarg);
+            if (batch_size <= 0)
+            {
+                std::cerr << "Invalid batch size: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.batch_size = static_cast<unsigned int>(batch_size);
+            break;
+        case 'F':
+        {
+            can_filter filter {};
+            if (!parse_filter(optarg, filter))
+            {
+                std::cerr << "Invalid filter: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.filters.push_back(filter);
+            break;
+        }
+        case 'j':
+            options.join_filters = true;
+            break;
+        case 'e':
+        {
+            uint64_t error_mask;
+            if (!parse_hex(optarg, CAN_ERR_MASK, error_mask))
+            {
+                std::cerr << "Invalid error mask: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.error_mask = static_cast<can_err_mask_t>(error_mask);
+            break;
+        }
+        case 'r':
+        {
+            int ring_capacity = std::atoi(optarg);
+            if (ring_capacity < 0)
+            {
+                std::cerr << "Invalid ring capacity: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.ring_capacity = static_cast<size_t>(ring_capacity);
+            break;
+        }
+        case 'H':
+            options.use_hw_timestamps = true;
+            break;
+        case 'R':
+        {
+            int receive_buffer_size = std::atoi(optarg);
+            if (receive_buffer_size <= 0)
+            {
+                std::cerr << "Invalid receive buffer size: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.receive_buffer_size = receive_buffer_size;
+            break;
+        }
+        case 'w':
+            options.capture_path = optarg;
+            break;
+        case 'c':
+        {
+            long long capacity = std::atoll(optarg);
+            if (capacity <= 0)
+            {
+                std::cerr << "Invalid capture capacity: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.capture_capacity = static_cast<uint64_t>(capacity);
+            break;
+        }
+        case 'q':
+            options.is_quiet = true;
+            break;
+        case 'n':
+        {
+            int every = std::atoi(optarg);
+            if (every <= 0)
+            {
+                std::cerr << "Invalid print interval: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.print_every = static_cast<unsigned int>(every);
+            break;
+        }
+        case 'D':
+            options.dbc_path = optarg;
+            break;
+        case 's':
+        {
+            int interval = std::atoi(optarg);
+            if (interval <= 0)
+            {
+                std::cerr << "Invalid statistics interval: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.statistics_interval_ms = static_cast<unsigned int>(interval);
+            break;
+        }
+        case 'o':
+            options.statistics_format = StatisticsFormat::Json;
+            break;
+        case 'B':
+            if (!parse_bitrate(optarg, options))
+            {
+                std::cerr << "Invalid bitrate: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'P':
+            options.use_packet_mmap = true;
+            break;
+        case 'U':
+            options.use_io_uring = true;
+            break;
+        case 'T':
+        {
+            int block_timeout = std::atoi(optarg);
+            if (block_timeout <= 0)
+            {
+                std::cerr << "Invalid block timeout: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.packet_block_timeout_ms = static_cast<unsigned int>(block_timeout);
+            break;
+        }
+        case 'd':
+            duration = std::atoi(optarg);
+            if (duration <= 0)
+            {
+                std::cerr << "Invalid duration: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'S':
+            if (!parse_scheduling(optarg, options.realtime))
+            {
+                std::cerr << "Invalid scheduling: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'a':
+            if (!parse_cpu_list(optarg, options.realtime.cpus))
+            {
+                std::cerr << "Invalid CPU list: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'L':
+            options.realtime.lock_memory = true;
+            break;
+        case 'i':
+            if (!parse_isotp_ids(optarg, options.isotp))
+            {
+                std::cerr << "Invalid ISO-TP IDs: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.use_isotp = true;
+            break;
+        case 'k':
+        {
+            int block_size = std::atoi(optarg);
+            if (block_size < 0 || block_size > 255)
+            {
+                std::cerr << "Invalid block size: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.isotp.block_size = static_cast<uint8_t>(block_size);
+            break;
+        }
+        case 'm':
+        {
+            int stmin = std::atoi(optarg);
+            if (stmin < 0 || stmin > 127'000)
+            {
+                std::cerr << "Invalid STmin: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.isotp.stmin = encode_isotp_stmin(static_cast<unsigned int>(stmin));
+            break;
+        }
+        case 'x':
+        {
+            uint64_t padding_byte;
+            if (!parse_hex(optarg, 0xFF, padding_byte))
+            {
+                std::cerr << "Invalid padding byte: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.isotp.use_padding = true;
+            options.isotp.padding_byte = static_cast<uint8_t>(padding_byte);
+            break;
+        }
+        case 'f':
+            options.isotp.is_fd = true;
+            break;
+        case 'J':
+            options.use_j1939 = true;
+            options.j1939.is_promiscuous = true;
+            break;
+        case 'G':
+            if (!parse_pgns(optarg, options.j1939.pgns))
+            {
+                std::cerr << "Invalid PGN list: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'N':
+        {
+            uint64_t name;
+            if (!parse_hex(optarg, std::numeric_limits<name_t>::max(), name))
+            {
+                std::cerr << "Invalid J1939 NAME: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.j1939.name = static_cast<name_t>(name);
+            break;
+        }
+        case 'A':
+        {
+            uint64_t address;
+            if (!parse_hex(optarg, J1939_MAX_UNICAST_ADDR, address))
+            {
+                std::cerr << "Invalid J1939 address: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.j1939.address = static_cast<uint8_t>(address);
+            break;
+        }
+        case 'h':
+            print_usage(argv[0]);
+            return EXIT_SUCCESS;
+        default:
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc)
     {
         print_usage(argv[0]);
         return EXIT_FAILURE;
     }
 
-    std::string_view interface_name {argv[1]};
-
-    CanReceiver receiver {interface_name};
+    std::vector<std::string> interface_names {argv + optind, argv + argc};
+    g_receiver = std::make_unique<CanReceiver>(interface_names, options);
 
-    if (receiver.initialize())
+    if (g_receiver->initialize())
     {
         std::cerr << "Failed to initialize CAN receiver" << std::endl;
         return EXIT_FAILURE;
     }
 
-    receiver.run();
+    if (duration > 0)
+    {
+        alarm(static_cast<unsigned int>(duration));
+    }
+
+    g_receiver->run();
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,118 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "output_buffer.h"
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+// Two uppercase hex digits for every byte value
+static constexpr std::array<std::array<char, 2>, 256> make_hex_table()
+{
+    constexpr char digits[] = "0123456789ABCDEF";
+    std::array<std::array<char, 2>, 256> table {};
+
+    for (size_t i = 0; i < table.size(); i++)
+    {
+        table[i] = {digits[i >> 4], digits[i & 0xF]};
+    }
+
+    return table;
+}
+
+static constexpr std::array<std::array<char, 2>, 256> HEX_TABLE = make_hex_table();
+
+OutputBuffer::OutputBuffer(size_t capacity) : m_data(capacity) {}
+
+char* OutputBuffer::reserve(size_t length)
+{
+    if (m_length + length > m_data.size())
+    {
+        flush();
+    }
+
+    // Longer than the whole buffer, only happens for text appended in one piece
+    if (length > m_data.size())
+    {
+        m_data.resize(length);
+    }
+
+    char* cursor = m_data.data() + m_length;
+    m_length += length;
+    return cursor;
+}
+
+void OutputBuffer::append(std::string_view text)
+{
+    std::memcpy(reserve(text.size()), text.data(), text.size());
+}
+
+void OutputBuffer::append(char c)
+{
+    *reserve(1) = c;
+}
+
+void OutputBuffer::append_decimal(uint64_t value, unsigned int width)
+{
+    char digits[20];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    size_t length = static_cast<size_t>(end - digits);
+    size_t padding = width > length ? width - length : 0;
+
+    char* cursor = reserve(padding + length);
+    std::memset(cursor, '0', padding);
+    std::memcpy(cursor + padding, digits, length);
+}
+
+void OutputBuffer::append_hex(uint64_t value)
+{
+    char digits[16];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value, 16).ptr;
+    size_t length = static_cast<size_t>(end - digits);
+
+    char* cursor = reserve(length);
+    for (size_t i = 0; i < length; i++)
+    {
+        cursor[i] = digits[i] >= 'a' ? static_cast<char>(digits[i] - 'a' + 'A') : digits[i];
+    }
+}
+
+void OutputBuffer::append_hex_byte(uint8_t value)
+{
+    std::memcpy(reserve(2), HEX_TABLE[value].data(), 2);
+}
+
+void OutputBuffer::append_double(double value)
+{
+    // Six significant digits like printf("%g"), the default precision of std::ostream
+    char digits[32];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6).ptr;
+    append(std::string_view(digits, static_cast<size_t>(end - digits)));
+}
+
+void OutputBuffer::flush()
+{
+    if (m_length == 0)
+    {
+        return;
+    }
+
+    std::cout.write(m_data.data(), static_cast<std::streamsize>(m_length));
+    std::cout.flush();
+    m_length = 0;
+}
@@ -0,0 +1,53 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Text output collected in a preallocated buffer and written to stdout in one piece by flush(), instead of one
+// formatted, flushed write per line. Numbers are formatted with std::to_chars and lookup tables, nothing here
+// allocates after construction.
+class OutputBuffer
+{
+  public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    explicit OutputBuffer(size_t capacity = DEFAULT_CAPACITY);
+
+    void append(std::string_view text);
+    void append(char c);
+    void append_decimal(uint64_t value, unsigned int width = 0); // Zero padded to width digits
+    void append_hex(uint64_t value);                             // Uppercase, no leading zeros
+    void append_hex_byte(uint8_t value);
+    void append_double(double value);                            // Six significant digits, as std::ostream
+
+    // Writes the collected text through std::cout, so it stays in order with other output
+    void flush();
+
+  private:
+    std::vector<char> m_data {};
+    size_t m_length {0};
+
+    char* reserve(size_t length);
+};
+
+#endif // OUTPUT_BUFFER_H
@@ -0,0 +1,139 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "packet_ring.h"
+#include <arpa/inet.h>
+#include <cstdio>
+#include <linux/if_ether.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+PacketRing::PacketRing() {}
+
+PacketRing::~PacketRing()
+{
+    close();
+}
+
+int PacketRing::open(int ifindex, unsigned int block_size, unsigned int block_count, unsigned int block_timeout_ms)
+{
+    int version = TPACKET_V3;
+    struct tpacket_req3 request {};
+    struct sockaddr_ll addr {};
+
+    m_ifindex = ifindex;
+    m_block_size = block_size;
+    m_block_count = block_count;
+    m_current_block = 0;
+
+    m_socket = ::socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (m_socket < 0)
+    {
+        perror("Error opening packet socket");
+        return 1;
+    }
+
+    if (setsockopt(m_socket, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+    {
+        perror("Error selecting TPACKET_V3");
+        close();
+        return 1;
+    }
+
+    // Frame size only matters for the ring geometry checks in V3, packets are packed back to back in a block
+    request.tp_block_size = block_size;
+    request.tp_block_nr = block_count;
+    request.tp_frame_size = TPACKET_ALIGNMENT << 7;
+    request.tp_frame_nr = block_size / request.tp_frame_size * block_count;
+    request.tp_retire_blk_tov = block_timeout_ms;
+    request.tp_feature_req_word = 0;
+
+    if (setsockopt(m_socket, SOL_PACKET, PACKET_RX_RING, &request, sizeof(request)) < 0)
+    {
+        perror("Error setting up packet receive ring");
+        close();
+        return 1;
+    }
+
+    m_mapping_size = static_cast<size_t>(block_size) * block_count;
+    m_mapping = mmap(nullptr, m_mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, m_socket, 0);
+    if (m_mapping == MAP_FAILED)
+    {
+        // MAP_LOCKED needs RLIMIT_MEMLOCK headroom, the ring still works without it
+        m_mapping = mmap(nullptr, m_mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_socket, 0);
+    }
+    if (m_mapping == MAP_FAILED)
+    {
+        m_mapping = nullptr;
+        perror("Error mapping packet receive ring");
+        close();
+        return 1;
+    }
+
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ALL);
+    addr.sll_ifindex = ifindex;
+
+    if (bind(m_socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        perror("Error binding packet socket");
+        close();
+        return 1;
+    }
+
+    return 0;
+}
+
+void PacketRing::close()
+{
+    if (m_mapping)
+    {
+        munmap(m_mapping, m_mapping_size);
+        m_mapping = nullptr;
+    }
+
+    if (m_socket >= 0)
+    {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+}
+
+int PacketRing::socket() const
+{
+    return m_socket;
+}
+
+int PacketRing::ifindex() const
+{
+    return m_ifindex;
+}
+
+uint64_t PacketRing::read_drop_count()
+{
+    struct tpacket_stats_v3 stats {};
+    socklen_t length = sizeof(stats);
+
+    // Reading the statistics resets them in the kernel
+    if (getsockopt(m_socket, SOL_PACKET, PACKET_STATISTICS, &stats, &length) < 0)
+    {
+        return 0;
+    }
+
+    return stats.tp_drops;
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PACKET_RING_H
+#define PACKET_RING_H
+
+#include <linux/can.h>
+#include <linux/if_packet.h>
+#include <cstddef>
+#include <cstdint>
+#include <time.h>
+
+// AF_PACKET receive ring (PACKET_RX_RING, TPACKET_V3) on one CAN interface.
+// The kernel writes frames straight into a mapping shared with userspace and hands over whole blocks, so a wakeup
+// delivers every frame of a block without a per-frame copy through a socket buffer. A block is handed over when it
+// is full or when its retire timeout expires, which bounds the added latency on a quiet bus.
+class PacketRing
+{
+  public:
+    PacketRing();
+    ~PacketRing();
+
+    PacketRing(const PacketRing&) = delete;
+    PacketRing& operator=(const PacketRing&) = delete;
+
+    int open(int ifindex, unsigned int block_size, unsigned int block_count, unsigned int block_timeout_ms);
+    void close();
+
+    int socket() const;
+    int ifindex() const;
+
+    // Calls handler(data, length, timestamp) for every received CAN frame in the blocks the kernel has handed over,
+    // then returns the blocks to the kernel. data points into the ring and holds CAN_MTU or CANFD_MTU bytes.
+    template <typename Handler>
+    unsigned int drain(Handler&& handler);
+
+    // Frames the kernel dropped because the ring was full, since the previous call
+    uint64_t read_drop_count();
+
+  private:
+    int m_socket {-1};
+    int m_ifindex {0};
+    void* m_mapping {nullptr};
+    size_t m_mapping_size {0};
+    unsigned int m_block_size {0};
+    unsigned int m_block_count {0};
+    unsigned int m_current_block {0};
+};
+
+template <typename Handler>
+unsigned int PacketRing::drain(Handler&& handler)
+{
+    unsigned int frame_count = 0;
+
+    while (true)
+    {
+        auto* block = reinterpret_cast<struct tpacket_block_desc*>(static_cast<char*>(m_mapping) +
+                                                                   static_cast<size_t>(m_current_block) * m_block_size);
+
+        if (!(__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER))
+        {
+            return frame_count;
+        }
+
+        auto* packet = reinterpret_cast<const struct tpacket3_hdr*>(reinterpret_cast<const char*>(block) +
+                                                                     block->hdr.bh1.offset_to_first_pkt);
+
+        for (uint32_t i = 0; i < block->hdr.bh1.num_pkts; i++)
+        {
+            auto* address = reinterpret_cast<const struct sockaddr_ll*>(reinterpret_cast<const char*>(packet) +
+                                                                        TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+
+            // Local transmissions come back through the CAN loopback as incoming packets, as CAN_RAW sockets see
+            // them. Skipping the PACKET_OUTGOING copy keeps them from being counted twice.
+            if (address->sll_pkttype != PACKET_OUTGOING &&
+                (packet->tp_snaplen == CAN_MTU || packet->tp_snaplen == CANFD_MTU))
+            {
+                struct timespec timestamp {static_cast<time_t>(packet->tp_sec), static_cast<long>(packet->tp_nsec)};
+                handler(reinterpret_cast<const uint8_t*>(packet) + packet->tp_mac, packet->tp_snaplen, timestamp);
+                frame_count++;
+            }
+
+            packet = reinterpret_cast<const struct tpacket3_hdr*>(reinterpret_cast<const char*>(packet) +
+                                                                  packet->tp_next_offset);
+        }
+
+        __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        m_current_block = (m_current_block + 1) % m_block_count;
+    }
+}
+
+#endif // PACKET_RING_H
@@ -0,0 +1,84 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "pgn_statistics.h"
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+void PgnStatistics::add(pgn_t pgn, size_t length, uint64_t now_ns)
+{
+    Entry& entry = m_entries[pgn];
+    uint64_t frames = frames_of(length);
+
+    entry.message_count++;
+    entry.byte_count += length;
+    entry.frame_count += frames;
+    m_frame_count += frames;
+
+    if (m_first_ns == 0)
+    {
+        m_first_ns = now_ns;
+    }
+    m_last_ns = now_ns;
+}
+
+uint64_t PgnStatistics::frames_of(size_t length)
+{
+    if (length <= 8)
+    {
+        return 1;
+    }
+
+    // Connection management frame plus 7 byte data packets; the CTS and end of message acknowledgement of a
+    // destination specific session are not counted
+    return 1 + (length + 6) / 7;
+}
+
+void PgnStatistics::report(std::ostream& out) const
+{
+    std::vector<pgn_t> pgns;
+    pgns.reserve(m_entries.size());
+    for (const auto& [pgn, entry] : m_entries)
+    {
+        pgns.push_back(pgn);
+    }
+
+    // Busiest PGNs first
+    std::sort(pgns.begin(), pgns.end(), [this](pgn_t a, pgn_t b) {
+        return m_entries.at(a).frame_count > m_entries.at(b).frame_count;
+    });
+
+    double seconds = (m_last_ns - m_first_ns) / 1e9;
+    std::ios_base::fmtflags flags = out.flags();
+
+    out << "Messages per PGN over " << std::fixed << std::setprecision(1) << seconds << " s:" << std::endl;
+    out << "      PGN   messages      msg/s      bytes        B/s  frame share" << std::endl;
+
+    for (pgn_t pgn : pgns)
+    {
+        const Entry& entry = m_entries.at(pgn);
+
+        out << "  0x" << std::hex << std::uppercase << std::setw(5) << std::setfill('0') << pgn << std::dec
+            << std::setfill(' ') << std::setw(11) << entry.message_count << std::setw(11)
+            << (seconds > 0 ? entry.message_count / seconds : 0.0) << std::setw(11) << entry.byte_count
+            << std::setw(11) << (seconds > 0 ? entry.byte_count / seconds : 0.0) << std::setw(12)
+            << 100.0 * entry.frame_count / m_frame_count << "%" << std::endl;
+    }
+
+    out.flags(flags);
+}
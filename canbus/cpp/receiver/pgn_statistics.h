@@ -0,0 +1,51 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PGN_STATISTICS_H
+#define PGN_STATISTICS_H
+
+#include <linux/can/j1939.h>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+
+// Per PGN message and byte rates of J1939 traffic, with each PGN's share of the CAN frames on the bus.
+// Messages longer than 8 bytes are counted with the frames of their transport protocol session.
+class PgnStatistics
+{
+  public:
+    void add(pgn_t pgn, size_t length, uint64_t now_ns);
+    void report(std::ostream& out) const;
+
+  private:
+    struct Entry
+    {
+        uint64_t message_count {0};
+        uint64_t byte_count {0};
+        uint64_t frame_count {0};
+    };
+
+    static uint64_t frames_of(size_t length);
+
+    std::unordered_map<pgn_t, Entry> m_entries {};
+    uint64_t m_first_ns {0};
+    uint64_t m_last_ns {0};
+    uint64_t m_frame_count {0};
+};
+
+#endif // PGN_STATISTICS_H
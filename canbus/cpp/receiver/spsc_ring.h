@@ -0,0 +1,127 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+// Head and tail live on separate cache lines so the two sides do not false-share, and each side keeps a
+// cached copy of the other's index so it only touches the shared line when the ring looks full or empty.
+template <typename T>
+class SpscRing
+{
+  public:
+    // Capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity) : m_slots(round_up(capacity)), m_mask {m_slots.size() - 1} {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side, returns false when the ring is full
+    bool push(const T& item)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head - m_cached_tail > m_mask)
+        {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cached_tail > m_mask)
+            {
+                return false;
+            }
+        }
+
+        m_slots[head & m_mask] = item;
+        m_head.store(head + 1, std::memory_order_release);
+
+        size_t occupancy = head + 1 - m_cached_tail;
+        if (occupancy > m_high_water.load(std::memory_order_relaxed))
+        {
+            m_high_water.store(occupancy, std::memory_order_relaxed);
+        }
+
+        return true;
+    }
+
+    // Consumer side, returns false when the ring is empty
+    bool pop(T& item)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail == m_cached_head)
+        {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+            if (tail == m_cached_head)
+            {
+                return false;
+            }
+        }
+
+        item = m_slots[tail & m_mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    size_t capacity() const
+    {
+        return m_slots.size();
+    }
+
+    // Number of queued items, exact only when called from the producer or consumer thread
+    size_t occupancy() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    // Highest occupancy seen by the producer, an upper bound since the tail it compares against may be stale
+    size_t high_water() const
+    {
+        return m_high_water.load(std::memory_order_relaxed);
+    }
+
+  private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    static size_t round_up(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    std::vector<T> m_slots;
+    const size_t m_mask;
+
+    // Producer-owned
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head {0};
+    size_t m_cached_tail {0};
+    std::atomic<size_t> m_high_water {0};
+
+    // Consumer-owned
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail {0};
+    size_t m_cached_head {0};
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,128 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "bcm_socket.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+BcmSocket::BcmSocket() {}
+
+BcmSocket::~BcmSocket()
+{
+    close();
+}
+
+int BcmSocket::open(const std::string& interface_name)
+{
+    struct sockaddr_can addr {};
+
+    m_socket = ::socket(PF_CAN, SOCK_DGRAM, CAN_BCM);
+    if (m_socket < 0)
+    {
+        perror("Error opening broadcast manager socket (is the can-bcm module loaded?)");
+        return 1;
+    }
+
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = static_cast<int>(if_nametoindex(interface_name.c_str()));
+
+    if (addr.can_ifindex == 0)
+    {
+        perror("Error getting interface index");
+        close();
+        return 1;
+    }
+
+    if (connect(m_socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        perror("Error connecting broadcast manager socket");
+        close();
+        return 1;
+    }
+
+    return 0;
+}
+
+void BcmSocket::close()
+{
+    if (m_socket >= 0)
+    {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+}
+
+int BcmSocket::start_cyclic(const canfd_frame& frame, bool is_fd, uint64_t period_us)
+{
+    // TX_ANNOUNCE sends the first frame immediately instead of one period after setup
+    return write_message(TX_SETUP, SETTIMER | STARTTIMER | TX_ANNOUNCE, period_us, frame, is_fd);
+}
+
+int BcmSocket::update(const canfd_frame& frame, bool is_fd)
+{
+    // TX_SETUP of an existing job without SETTIMER only copies the new frame into it
+    return write_message(TX_SETUP, 0, 0, frame, is_fd);
+}
+
+int BcmSocket::stop_cyclic(canid_t can_id, bool is_fd)
+{
+    canfd_frame frame {};
+    frame.can_id = can_id;
+
+    return write_message(TX_DELETE, 0, 0, frame, is_fd);
+}
+
+int BcmSocket::write_message(uint32_t opcode, uint32_t flags, uint64_t period_us, const canfd_frame& frame,
+                             bool is_fd)
+{
+    // Message head followed by one frame, which the kernel expects 8 byte aligned
+    alignas(8) uint8_t buffer[sizeof(struct bcm_msg_head) + CANFD_MTU];
+    struct bcm_msg_head head {};
+
+    head.opcode = opcode;
+    head.flags = flags | (is_fd ? CAN_FD_FRAME : 0);
+    head.ival2.tv_sec = static_cast<long>(period_us / 1'000'000);
+    head.ival2.tv_usec = static_cast<long>(period_us % 1'000'000);
+    head.can_id = frame.can_id;
+    head.nframes = opcode == TX_DELETE ? 0 : 1;
+
+    // can_frame and canfd_frame share their layout, a classic frame is the first CAN_MTU bytes
+    size_t frame_size = head.nframes * (is_fd ? CANFD_MTU : CAN_MTU);
+    std::memcpy(buffer, &head, sizeof(head));
+    std::memcpy(buffer + sizeof(head), &frame, frame_size);
+
+    size_t size = sizeof(head) + frame_size;
+    ssize_t nbytes = write(m_socket, buffer, size);
+
+    if (nbytes < 0)
+    {
+        perror("Error writing broadcast manager message");
+        return 1;
+    }
+
+    if (nbytes < static_cast<ssize_t>(size))
+    {
+        std::cout << "Warning: incomplete broadcast manager message written" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef BCM_SOCKET_H
+#define BCM_SOCKET_H
+
+#include <linux/can.h>
+#include <linux/can/bcm.h>
+#include <cstdint>
+#include <string>
+
+// Kernel CAN broadcast manager socket. Each TX job is one CAN ID the kernel sends from an hrtimer at a fixed
+// period, so cyclic traffic costs no userspace wakeups and its period does not depend on process scheduling.
+class BcmSocket
+{
+  public:
+    BcmSocket();
+    ~BcmSocket();
+
+    BcmSocket(const BcmSocket&) = delete;
+    BcmSocket& operator=(const BcmSocket&) = delete;
+
+    int open(const std::string& interface_name);
+    void close();
+
+    // Starts sending frame every period_us, the first one right away
+    int start_cyclic(const canfd_frame& frame, bool is_fd, uint64_t period_us);
+
+    // Replaces the payload of a running job, its timer keeps running
+    int update(const canfd_frame& frame, bool is_fd);
+
+    int stop_cyclic(canid_t can_id, bool is_fd);
+
+  private:
+    int m_socket {-1};
+
+    int write_message(uint32_t opcode, uint32_t flags, uint64_t period_us, const canfd_frame& frame, bool is_fd);
+};
+
+#endif // BCM_SOCKET_H
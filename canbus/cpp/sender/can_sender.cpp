@@ -16,21 +16,47 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "can_sender.h"
+#include "candump_format.h"
+#include "hex_parse.h"
+#include "raw_socket.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <net/if.h>
+#include <poll.h>
+#include <sstream>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
-CanSender::CanSender(std::string_view interface_name) : m_interface_name {interface_name} {}
+static uint64_t realtime_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+}
+
+CanSender::CanSender(std::string_view interface_name, const CanSenderOptions& options)
+    : m_interface_name {interface_name}, m_options {options}
+{
+}
 
 CanSender::~CanSender()
 {
     if (m_socket >= 0)
     {
+        if (m_tx_latency)
+        {
+            m_tx_latency->restore(m_socket);
+        }
         close(m_socket);
         m_socket = -1;
     }
@@ -41,11 +67,98 @@ int CanSender::initialize()
     std::cout << "CAN Sender starting on interface: " << m_interface_name << std::endl;
     std::cout << "Press Ctrl+C to exit.\n" << std::endl;
 
+    if (m_options.use_isotp)
+    {
+        if (m_isotp.open(m_interface_name, m_options.isotp))
+        {
+            return 1;
+        }
+
+        std::cout << "ISO-TP from 0x" << std::hex << std::uppercase << (m_options.isotp.tx_id & CAN_EFF_MASK)
+                  << " to 0x" << (m_options.isotp.rx_id & CAN_EFF_MASK) << std::dec
+                  << (m_options.isotp.is_fd ? ", CAN FD" : "")
+                  << (m_options.isotp.use_padding ? ", padded" : "") << std::endl;
+        return 0;
+    }
+
+    if (m_options.use_j1939)
+    {
+        if (m_j1939.open(m_interface_name, m_options.j1939))
+        {
+            return 1;
+        }
+
+        if (m_j1939.address() > J1939_MAX_UNICAST_ADDR)
+        {
+            std::cerr << "J1939 needs a source address, give --address or --name" << std::endl;
+            return 1;
+        }
+
+        std::cout << "J1939 PGN 0x" << std::hex << std::uppercase << m_options.j1939_pgn << " from 0x"
+                  << static_cast<int>(m_j1939.address()) << " to 0x" << static_cast<int>(m_options.j1939_destination)
+                  << std::dec << ", priority " << static_cast<int>(m_options.j1939.priority) << std::endl;
+        return 0;
+    }
+
     if (setup_socket() || bind_socket())
     {
         return 1;
     }
 
+    if (!m_options.replay_path.empty() && load_replay())
+    {
+        return 1;
+    }
+
+    if (!m_options.schedule_path.empty() && load_schedule())
+    {
+        return 1;
+    }
+
+    if (m_options.use_hw_timestamps && !m_options.measure_tx_latency)
+    {
+        std::cout << "Warning: Hardware timestamps are only used with --tx-latency" << std::endl;
+    }
+
+    if (m_options.measure_tx_latency)
+    {
+        if (!m_options.bcm_jobs.empty())
+        {
+            std::cout << "Warning: Cyclic frames are sent by the broadcast manager, their latency is not measured"
+                      << std::endl;
+        }
+
+        m_tx_latency = std::make_unique<TxLatency>();
+        if (m_tx_latency->setup(m_socket, m_interface_name, m_options.use_hw_timestamps))
+        {
+            return 1;
+        }
+    }
+
+    // The raw socket stays open for the END frame
+    if (!m_options.bcm_jobs.empty() && m_bcm.open(m_interface_name))
+    {
+        return 1;
+    }
+
+    // One schedule tick sends every message due at once, which can be the whole table, as one chain
+    if (m_options.use_io_uring)
+    {
+        if (!m_options.is_generator && m_schedule.empty())
+        {
+            std::cout << "Warning: Only the generator and the schedule table send through io_uring" << std::endl;
+        }
+        else if (m_uring.open(std::max(m_options.batch_size, static_cast<unsigned int>(m_schedule.size()))))
+        {
+            return 1;
+        }
+    }
+
+    if (m_options.realtime.lock_memory)
+    {
+        lock_memory();
+    }
+
     return 0;
 }
 
@@ -78,6 +191,11 @@ int CanSender::bind_socket()
 
     std::cout << "Interface " << m_interface_name << " at index " << ifr.ifr_ifindex << std::endl;
 
+    if (m_options.is_fd && enable_fd_frames(ifr))
+    {
+        return 1;
+    }
+
     if (bind(m_socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
     {
         perror("Error in socket bind");
@@ -87,24 +205,151 @@ int CanSender::bind_socket()
     return 0;
 }
 
+int CanSender::enable_fd_frames(const struct ifreq& ifr)
+{
+    struct ifreq mtu_ifr = ifr;
+    int enable_fd = 1;
+
+    if (ioctl(m_socket, SIOCGIFMTU, &mtu_ifr) < 0)
+    {
+        perror("Error getting interface MTU");
+        return 1;
+    }
+
+    if (mtu_ifr.ifr_mtu != CANFD_MTU)
+    {
+        std::cerr << "Interface " << m_interface_name << " has MTU " << mtu_ifr.ifr_mtu << ", CAN FD needs "
+                  << CANFD_MTU << " (ip link set " << m_interface_name << " mtu " << CANFD_MTU << ")" << std::endl;
+        return 1;
+    }
+
+    if (setsockopt(m_socket, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable_fd, sizeof(enable_fd)) < 0)
+    {
+        perror("Error enabling CAN FD frames");
+        return 1;
+    }
+
+    return 0;
+}
+
+bool CanSender::is_valid_length(unsigned int length, bool is_fd)
+{
+    if (length <= CAN_MAX_DLEN)
+    {
+        return true;
+    }
+
+    // Above 8 bytes CAN FD only has discrete DLC steps
+    switch (length)
+    {
+    case 12:
+    case 16:
+    case 20:
+    case 24:
+    case 32:
+    case 48:
+    case 64:
+        return is_fd;
+    default:
+        return false;
+    }
+}
+
+// Parses "counter", "random", "timestamp" or "fixed:HEXBYTES"
+bool CanSender::parse_pattern(const std::string& text, PayloadPattern& pattern, std::vector<uint8_t>& fixed_payload)
+{
+    if (text == "counter")
+    {
+        pattern = PayloadPattern::Counter;
+        return true;
+    }
+
+    if (text == "random")
+    {
+        pattern = PayloadPattern::Random;
+        return true;
+    }
+
+    if (text == "timestamp")
+    {
+        pattern = PayloadPattern::Timestamp;
+        return true;
+    }
+
+    // The payload repeats over the frame, so more than one CAN FD frame of it would never be sent
+    if (text.rfind("fixed:", 0) != 0 ||
+        !parse_hex_bytes(std::string_view {text}.substr(6), CANFD_MAX_DLEN, fixed_payload))
+    {
+        return false;
+    }
+
+    pattern = PayloadPattern::Fixed;
+    return true;
+}
+
 void CanSender::run()
 {
     m_is_running = true;
 
-    while (m_is_running)
+    if (m_options.realtime.is_enabled())
     {
-        send_data_frame();
+        apply_realtime(m_options.realtime, 0, "sending");
+    }
+
+    if (m_options.use_isotp)
+    {
+        run_messages("ISO-TP", [this](const uint8_t* data, size_t length) { return m_isotp.send(data, length); });
+        send_isotp_end_message();
+        return;
+    }
 
-        // Prevent overflow
-        if (++m_frame_index > 999)
+    if (m_options.use_j1939)
+    {
+        run_messages("J1939", [this](const uint8_t* data, size_t length) {
+            return m_j1939.send(m_options.j1939_pgn, m_options.j1939_destination, data, length);
+        });
+        return;
+    }
+
+    if (!m_options.bcm_jobs.empty())
+    {
+        run_bcm();
+    }
+    else if (!m_replay_records.empty())
+    {
+        run_replay();
+    }
+    else if (!m_schedule.empty())
+    {
+        run_schedule();
+    }
+    else if (m_options.is_generator)
+    {
+        run_generator();
+    }
+    else
+    {
+        while (m_is_running)
         {
-            m_frame_index = 0;
-        }
+            send_data_frame();
 
-        sleep(1);
+            // Prevent overflow
+            if (++m_frame_index > 999)
+            {
+                m_frame_index = 0;
+            }
+
+            sleep(1);
+        }
     }
 
     send_end_frame();
+
+    if (m_tx_latency)
+    {
+        m_tx_latency->finish(m_socket, 1000);
+        m_tx_latency->report(std::cout);
+    }
 }
 
 void CanSender::stop()
@@ -114,17 +359,34 @@ void CanSender::stop()
 
 void CanSender::send_data_frame()
 {
-    can_frame frame;
+    canfd_frame frame {};
     frame.can_id = 0x123;
-    frame.can_dlc = 8;
+    frame.len = static_cast<__u8>(m_options.payload_length);
+    frame.flags = (m_options.is_fd && m_options.use_brs) ? CANFD_BRS : 0;
+
+    char text[CAN_MAX_DLEN + 1];
+    std::snprintf(text, sizeof(text), "MSG_%03d", m_frame_index);
+    std::memcpy(frame.data, text, std::min<size_t>(frame.len, CAN_MAX_DLEN));
 
-    std::snprintf(reinterpret_cast<char*>(frame.data), sizeof(frame.data), "MSG_%03d", m_frame_index);
+    // Fill the rest of a CAN FD payload with a byte counter
+    for (unsigned int i = CAN_MAX_DLEN; i < frame.len; i++)
+    {
+        frame.data[i] = static_cast<__u8>(i);
+    }
 
-    std::cout << "Sending: ID=0x" << std::hex << std::uppercase << frame.can_id << std::dec
-              << ", DLC=" << static_cast<int>(frame.can_dlc) << ", Data='" << reinterpret_cast<char*>(frame.data) << "'"
+    std::cout << "Sending: ID=0x" << std::hex << std::uppercase << frame.can_id << std::dec;
+    if (m_options.is_fd)
+    {
+        std::cout << ", FD" << (m_options.use_brs ? "+BRS" : "") << ", LEN=" << static_cast<int>(frame.len);
+    }
+    else
+    {
+        std::cout << ", DLC=" << static_cast<int>(frame.len);
+    }
+    std::cout << ", Data='" << std::string_view(text, std::min<size_t>(frame.len, std::strlen(text))) << "'"
               << std::endl;
 
-    if (send_frame(frame))
+    if (send_frame(frame, m_options.is_fd))
     {
         std::cerr << "Failed to send data frame" << std::endl;
     }
@@ -132,20 +394,24 @@ void CanSender::send_data_frame()
 
 void CanSender::send_end_frame()
 {
-    can_frame frame;
+    // Always a classic frame so receivers without CAN FD support see it too
+    canfd_frame frame {};
     frame.can_id = 0x124;
-    frame.can_dlc = 3;
-    std::strcpy(reinterpret_cast<char*>(frame.data), "END");
+    frame.len = 3;
+    std::memcpy(frame.data, "END", 3);
 
-    std::cout << "Sending END message: ID=0x" << std::hex << std::uppercase << frame.can_id << std::dec << ", Data='"
-              << reinterpret_cast<char*>(frame.data) << "'" << std::endl;
+    std::cout << "Sending END message: ID=0x" << std::hex << std::uppercase << frame.can_id << std::dec
+              << ", Data='END'" << std::endl;
 
-    send_frame(frame);
+    send_frame(frame, false);
 }
 
-int CanSender::send_frame(const can_frame& frame)
+int CanSender::send_frame(const canfd_frame& frame, bool is_fd)
 {
-    ssize_t nbytes = write(m_socket, &frame, sizeof(can_frame));
+    // can_frame and canfd_frame share their layout, a classic frame is the first CAN_MTU bytes
+    size_t mtu = is_fd ? CANFD_MTU : CAN_MTU;
+    uint64_t queued_ns = m_tx_latency ? realtime_ns() : 0;
+    ssize_t nbytes = write(m_socket, &frame, mtu);
 
     if (nbytes < 0)
     {
@@ -153,11 +419,910 @@ int CanSender::send_frame(const can_frame& frame)
         return 1;
     }
 
-    if (nbytes < static_cast<ssize_t>(sizeof(can_frame)))
+    if (nbytes < static_cast<ssize_t>(mtu))
     {
         std::cout << "Warning: incomplete CAN frame sent" << std::endl;
         return 1;
     }
 
+    if (m_tx_latency)
+    {
+        m_tx_latency->add_sent(frame.can_id, queued_ns);
+        m_tx_latency->collect(m_socket);
+    }
+
+    return 0;
+}
+
+int CanSender::load_replay()
+{
+    const std::string& path = m_options.replay_path;
+    std::ifstream file {path, std::ios::binary};
+    char magic[sizeof(CAPTURE_MAGIC)] {};
+
+    if (!file)
+    {
+        std::cerr << "Error opening replay file: " << path << std::endl;
+        return 1;
+    }
+    file.read(magic, sizeof(magic));
+    file.close();
+
+    if (std::memcmp(magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) == 0)
+    {
+        CaptureReader reader {};
+        if (reader.open(path))
+        {
+            return 1;
+        }
+
+        m_replay_records.reserve(reader.record_count());
+        for (uint64_t i = 0; i < reader.record_count(); i++)
+        {
+            m_replay_records.push_back(reader.record(i));
+        }
+    }
+    else if (load_candump_log(path))
+    {
+        return 1;
+    }
+
+    // Error frames are generated by controllers, they cannot be sent
+    m_replay_records.erase(std::remove_if(m_replay_records.begin(), m_replay_records.end(),
+                                          [](const CaptureRecord& record) { return record.can_id & CAN_ERR_FLAG; }),
+                           m_replay_records.end());
+
+    if (m_replay_records.empty())
+    {
+        std::cerr << "No frames to replay in " << path << std::endl;
+        return 1;
+    }
+
+    bool has_fd_frames = std::any_of(m_replay_records.begin(), m_replay_records.end(),
+                                     [](const CaptureRecord& record) { return record.record_flags & CAPTURE_FLAG_FD; });
+    if (has_fd_frames && !m_options.is_fd)
+    {
+        std::cerr << "Replay file contains CAN FD frames, use --fd" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Loaded " << m_replay_records.size() << " frame(s) to replay from " << path << std::endl;
+
+    return 0;
+}
+
+int CanSender::load_candump_log(const std::string& path)
+{
+    std::ifstream file {path};
+    std::string line;
+    unsigned int line_number = 0;
+
+    while (std::getline(file, line))
+    {
+        CaptureRecord record;
+        line_number++;
+
+        if (line.empty())
+        {
+            continue;
+        }
+
+        if (!parse_candump_line(line.c_str(), record))
+        {
+            std::cerr << path << ":" << line_number << ": not a candump log line" << std::endl;
+            return 1;
+        }
+
+        m_replay_records.push_back(record);
+    }
+
+    return 0;
+}
+
+void CanSender::run_replay()
+{
+    const double speed = m_options.replay_speed;
+    const uint64_t first_ns = m_replay_records.front().timestamp_ns;
+    struct timespec start;
+    struct timespec end;
+    uint64_t sent_count = 0;
+    uint64_t late_count = 0;
+    double total_error_ns = 0;
+    double max_error_ns = 0;
+
+    if (speed > 0)
+    {
+        std::cout << "Replaying at " << speed << "x speed" << std::endl;
+    }
+    else
+    {
+        std::cout << "Replaying as fast as possible" << std::endl;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    const uint64_t start_ns = static_cast<uint64_t>(start.tv_sec) * 1'000'000'000 + start.tv_nsec;
+
+    for (const CaptureRecord& record : m_replay_records)
+    {
+        if (!m_is_running)
+        {
+            break;
+        }
+
+        if (speed > 0)
+        {
+            // Absolute deadlines keep errors from accumulating over a long replay
+            uint64_t offset_ns = record.timestamp_ns >= first_ns ? record.timestamp_ns - first_ns : 0;
+            uint64_t deadline_ns = start_ns + static_cast<uint64_t>(std::llround(offset_ns / speed));
+            struct timespec deadline {static_cast<time_t>(deadline_ns / 1'000'000'000),
+                                      static_cast<long>(deadline_ns % 1'000'000'000)};
+
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR && m_is_running)
+            {
+            }
+
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            double error_ns = static_cast<double>(static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec) -
+                              static_cast<double>(deadline_ns);
+
+            total_error_ns += std::fabs(error_ns);
+            max_error_ns = std::max(max_error_ns, std::fabs(error_ns));
+            if (error_ns > 1'000'000)
+            {
+                late_count++;
+            }
+        }
+
+        canfd_frame frame {};
+        bool is_fd = record.record_flags & CAPTURE_FLAG_FD;
+        frame.can_id = record.can_id;
+        frame.len = std::min<uint8_t>(record.len, is_fd ? CANFD_MAX_DLEN : CAN_MAX_DLEN);
+        frame.flags = is_fd ? record.fd_flags : 0;
+        std::memcpy(frame.data, record.data, frame.len);
+
+        if (send_frame(frame, is_fd) == 0)
+        {
+            sent_count++;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    double captured = (m_replay_records.back().timestamp_ns - first_ns) / 1e9;
+
+    std::cout << "Replayed " << sent_count << " of " << m_replay_records.size() << " frame(s) in " << elapsed
+              << " s (" << (elapsed > 0 ? sent_count / elapsed : 0.0) << " frames/s), capture spans " << captured
+              << " s" << std::endl;
+
+    if (speed > 0 && sent_count > 0)
+    {
+        std::cout << "Timing error: mean " << total_error_ns / sent_count / 1000 << " us, max " << max_error_ns / 1000
+                  << " us, " << late_count << " frame(s) more than 1 ms late" << std::endl;
+    }
+}
+
+void CanSender::setup_tx_batch(unsigned int batch_size)
+{
+    size_t mtu = m_options.is_fd ? CANFD_MTU : CAN_MTU;
+
+    m_tx_frames.assign(batch_size, canfd_frame {});
+    m_tx_iovecs.resize(batch_size);
+    m_tx_messages.resize(batch_size);
+
+    for (unsigned int i = 0; i < batch_size; i++)
+    {
+        m_tx_iovecs[i].iov_base = &m_tx_frames[i];
+        m_tx_iovecs[i].iov_len = mtu;
+
+        std::memset(&m_tx_messages[i], 0, sizeof(struct mmsghdr));
+        m_tx_messages[i].msg_hdr.msg_iov = &m_tx_iovecs[i];
+        m_tx_messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    if (m_options.realtime.lock_memory)
+    {
+        prefault(m_tx_frames.data(), m_tx_frames.size() * sizeof(canfd_frame));
+    }
+}
+
+void CanSender::fill_payload(canfd_frame& frame, uint64_t counter, PayloadPattern pattern,
+                             const std::vector<uint8_t>& fixed_payload)
+{
+    switch (pattern)
+    {
+    case PayloadPattern::Counter:
+        for (unsigned int i = 0; i < frame.len; i++)
+        {
+            frame.data[i] = i < sizeof(counter) ? static_cast<uint8_t>(counter >> (8 * i)) : 0;
+        }
+        break;
+    case PayloadPattern::Random:
+        for (unsigned int i = 0; i < frame.len; i += sizeof(m_random_state))
+        {
+            m_random_state ^= m_random_state << 13;
+            m_random_state ^= m_random_state >> 7;
+            m_random_state ^= m_random_state << 17;
+            std::memcpy(frame.data + i, &m_random_state, std::min<size_t>(sizeof(m_random_state), frame.len - i));
+        }
+        break;
+    case PayloadPattern::Timestamp:
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        uint64_t now_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+        for (unsigned int i = 0; i < frame.len; i++)
+        {
+            frame.data[i] = i < sizeof(now_ns) ? static_cast<uint8_t>(now_ns >> (8 * i)) : 0;
+        }
+        break;
+    }
+    case PayloadPattern::Fixed:
+        for (unsigned int i = 0; i < frame.len; i++)
+        {
+            frame.data[i] = fixed_payload.empty() ? 0 : fixed_payload[i % fixed_payload.size()];
+        }
+        break;
+    }
+}
+
+unsigned int CanSender::send_batch(unsigned int count, uint64_t& backpressure_count, uint64_t& drop_count)
+{
+    if (m_uring.is_open())
+    {
+        return send_uring_batch(count, backpressure_count, drop_count);
+    }
+
+    unsigned int index = 0;
+    unsigned int sent = 0;
+
+    while (index < count && m_is_running)
+    {
+        uint64_t queued_ns = m_tx_latency ? realtime_ns() : 0;
+        int result = sendmmsg(m_socket, &m_tx_messages[index], count - index, 0);
+
+        if (result > 0)
+        {
+            if (m_tx_latency)
+            {
+                for (int i = 0; i < result; i++)
+                {
+                    m_tx_latency->add_sent(m_tx_frames[index + i].can_id, queued_ns);
+                }
+                m_tx_latency->collect(m_socket);
+            }
+
+            index += static_cast<unsigned int>(result);
+            sent += static_cast<unsigned int>(result);
+            continue;
+        }
+
+        if (errno == ENOBUFS || errno == EAGAIN)
+        {
+            backpressure_count++;
+            wait_for_tx_queue(m_socket);
+            continue;
+        }
+
+        if (errno == EINTR)
+        {
+            continue;
+        }
+
+        // Skip the frame that failed and keep going
+        perror("Error sending CAN frames");
+        drop_count++;
+        index++;
+    }
+
+    return sent;
+}
+
+unsigned int CanSender::send_uring_batch(unsigned int count, uint64_t& backpressure_count, uint64_t& drop_count)
+{
+    unsigned int index = 0;
+    unsigned int sent = 0;
+
+    while (index < count && m_is_running)
+    {
+        // Linked so the frames leave in order, a frame that fails cancels the rest of the chain
+        unsigned int queued = 0;
+        struct io_uring_sqe* last_sqe = nullptr;
+        for (unsigned int i = index; i < count; i++)
+        {
+            struct io_uring_sqe* sqe = m_uring.get_sqe();
+            if (sqe == nullptr)
+            {
+                break;
+            }
+
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->fd = m_socket;
+            sqe->addr = reinterpret_cast<uint64_t>(&m_tx_messages[i].msg_hdr);
+            sqe->len = 1;
+            sqe->flags = IOSQE_IO_LINK;
+            sqe->user_data = i;
+            last_sqe = sqe;
+            queued++;
+        }
+        if (last_sqe == nullptr)
+        {
+            // Every earlier chain was reaped, so the queue only stays full if it was opened too small
+            std::cerr << "Error: io_uring submission queue is full" << std::endl;
+            return sent;
+        }
+        last_sqe->flags = 0;
+
+        // A chain is complete once every entry of it has completed, cancelled ones included. Frames that did not
+        // fit into the submission queue go out with the next chain.
+        unsigned int next_index = index + queued;
+        bool is_queue_full = false;
+        unsigned int completed = 0;
+        uint64_t queued_ns = m_tx_latency ? realtime_ns() : 0;
+
+        while (completed < queued)
+        {
+            if (m_uring.submit(queued - completed) < 0 && errno != EINTR)
+            {
+                perror("Error submitting CAN frames");
+                return sent;
+            }
+
+            completed += m_uring.drain([&](const struct io_uring_cqe& cqe) {
+                unsigned int frame_index = static_cast<unsigned int>(cqe.user_data);
+
+                if (cqe.res >= 0)
+                {
+                    sent++;
+                    if (m_tx_latency)
+                    {
+                        m_tx_latency->add_sent(m_tx_frames[frame_index].can_id, queued_ns);
+                    }
+                }
+                else if (cqe.res == -ENOBUFS || cqe.res == -EAGAIN)
+                {
+                    is_queue_full = true;
+                    next_index = std::min(next_index, frame_index);
+                }
+                else if (cqe.res != -ECANCELED)
+                {
+                    // Skip the frame that failed and keep going
+                    errno = -cqe.res;
+                    perror("Error sending CAN frames");
+                    drop_count++;
+                    next_index = std::min(next_index, frame_index + 1);
+                }
+            });
+        }
+
+        index = next_index;
+
+        if (m_tx_latency)
+        {
+            m_tx_latency->collect(m_socket);
+        }
+
+        if (is_queue_full)
+        {
+            backpressure_count++;
+            wait_for_tx_queue(m_socket);
+        }
+    }
+
+    return sent;
+}
+
+void CanSender::run_generator()
+{
+    const double rate = m_options.generator_rate;
+    const std::vector<canid_t>& ids = m_options.generator_ids;
+    unsigned int batch_size = m_options.batch_size;
+
+    // At low rates shrink the batch so frames go out at least every millisecond instead of in large bursts
+    if (rate > 0)
+    {
+        batch_size = std::clamp(static_cast<unsigned int>(rate / 1000), 1U, m_options.batch_size);
+    }
+    setup_tx_batch(batch_size);
+
+    if (rate > 0)
+    {
+        std::cout << "Generating " << rate << " frames/s";
+    }
+    else
+    {
+        std::cout << "Generating frames as fast as possible";
+    }
+    std::cout << " on " << ids.size() << " ID(s), " << batch_size << " frame(s) per "
+              << (m_uring.is_open() ? "io_uring submission" : "syscall") << std::endl;
+
+    const uint64_t batch_period_ns = rate > 0 ? static_cast<uint64_t>(std::llround(batch_size * 1e9 / rate)) : 0;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const uint64_t start_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+    uint64_t deadline_ns = start_ns;
+    uint64_t last_report_ns = start_ns;
+
+    uint64_t frame_counter = 0;
+    uint64_t sent_count = 0;
+    uint64_t interval_sent_count = 0;
+    uint64_t backpressure_count = 0;
+    uint64_t drop_count = 0;
+    uint64_t interval_drop_count = 0;
+
+    while (m_is_running)
+    {
+        for (unsigned int i = 0; i < batch_size; i++)
+        {
+            canfd_frame& frame = m_tx_frames[i];
+            frame.can_id = ids[frame_counter % ids.size()];
+            frame.len = static_cast<__u8>(m_options.payload_length);
+            frame.flags = (m_options.is_fd && m_options.use_brs) ? CANFD_BRS : 0;
+            fill_payload(frame, frame_counter, m_options.pattern, m_options.fixed_payload);
+            frame_counter++;
+        }
+
+        uint64_t dropped_before = drop_count;
+        unsigned int sent = send_batch(batch_size, backpressure_count, drop_count);
+        sent_count += sent;
+        interval_sent_count += sent;
+        interval_drop_count += drop_count - dropped_before;
+
+        if (batch_period_ns > 0)
+        {
+            deadline_ns += batch_period_ns;
+            struct timespec deadline {static_cast<time_t>(deadline_ns / 1'000'000'000),
+                                      static_cast<long>(deadline_ns % 1'000'000'000)};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t now_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+        if (now_ns - last_report_ns >= 1'000'000'000)
+        {
+            double interval = (now_ns - last_report_ns) / 1e9;
+            std::cout << "Sent " << static_cast<uint64_t>(interval_sent_count / interval) << " frames/s, dropped "
+                      << interval_drop_count << ", backpressure waits " << backpressure_count << std::endl;
+            interval_sent_count = 0;
+            interval_drop_count = 0;
+            last_report_ns = now_ns;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = (static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec - start_ns) / 1e9;
+
+    std::cout << "Generated " << sent_count << " frame(s) in " << elapsed << " s ("
+              << (elapsed > 0 ? sent_count / elapsed : 0.0) << " frames/s), dropped " << drop_count
+              << ", backpressure waits " << backpressure_count << std::endl;
+}
+
+int CanSender::load_schedule()
+{
+    const std::string& path = m_options.schedule_path;
+    std::ifstream file {path};
+    std::string line;
+    unsigned int line_number = 0;
+
+    if (!file)
+    {
+        std::cerr << "Error opening schedule file: " << path << std::endl;
+        return 1;
+    }
+
+    while (std::getline(file, line))
+    {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream stream {line};
+        std::string id_text;
+        double period_ms = 0;
+        double offset_ms = 0;
+        std::string pattern_text;
+        if (!(stream >> id_text))
+        {
+            continue;
+        }
+
+        ScheduledMessage message {0, 0, 0, m_options.payload_length, PayloadPattern::Counter, {}};
+        char* end;
+        unsigned long id = std::strtoul(id_text.c_str(), &end, 16);
+        bool is_valid = *end == '\0' && id <= CAN_EFF_MASK && stream >> period_ms >> offset_ms >> pattern_text &&
+                        period_ms >= 0.001 && offset_ms >= 0 &&
+                        parse_pattern(pattern_text, message.pattern, message.fixed_payload);
+
+        // The length column is optional
+        unsigned int length = 0;
+        if (is_valid && stream >> length)
+        {
+            message.length = length;
+            is_valid = is_valid_length(length, m_options.is_fd);
+        }
+
+        // Anything left over, a length that is not a number included
+        std::string rest;
+        stream.clear();
+        if (!is_valid || stream >> rest)
+        {
+            std::cerr << path << ":" << line_number << ": expected ID PERIOD_MS OFFSET_MS PATTERN [LENGTH]"
+                      << std::endl;
+            return 1;
+        }
+
+        message.can_id = id > CAN_SFF_MASK ? static_cast<canid_t>(id) | CAN_EFF_FLAG : static_cast<canid_t>(id);
+        message.period_ns = static_cast<uint64_t>(std::llround(period_ms * 1e6));
+        message.offset_ns = static_cast<uint64_t>(std::llround(offset_ms * 1e6));
+        m_schedule.push_back(std::move(message));
+    }
+
+    if (m_schedule.empty())
+    {
+        std::cerr << "No messages in schedule file " << path << std::endl;
+        return 1;
+    }
+
+    std::cout << "Loaded " << m_schedule.size() << " scheduled message(s) from " << path << std::endl;
+
     return 0;
 }
+
+void CanSender::run_schedule()
+{
+    // Period statistics of one message, measured between the sends of consecutive ticks
+    struct MessageState
+    {
+        uint64_t deadline_ns;
+        uint64_t last_sent_ns;
+        uint64_t sent_count;
+        uint64_t overrun_count;
+        uint64_t min_period_ns;
+        uint64_t max_period_ns;
+        double jitter_sum_ns;
+        double jitter_square_sum_ns;
+    };
+
+    setup_tx_batch(static_cast<unsigned int>(m_schedule.size()));
+
+    double frames_per_second = 0;
+    for (const ScheduledMessage& message : m_schedule)
+    {
+        frames_per_second += 1e9 / message.period_ns;
+    }
+    std::cout << "Sending " << m_schedule.size() << " scheduled message(s) at " << frames_per_second
+              << " frames/s in total" << std::endl;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const uint64_t start_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+
+    std::vector<MessageState> states(m_schedule.size());
+    for (size_t i = 0; i < m_schedule.size(); i++)
+    {
+        states[i] = {start_ns + m_schedule[i].offset_ns, 0, 0, 0, std::numeric_limits<uint64_t>::max(), 0, 0, 0};
+    }
+
+    std::vector<size_t> due(m_schedule.size());
+    uint64_t tick_count = 0;
+    uint64_t sent_count = 0;
+    uint64_t backpressure_count = 0;
+    uint64_t drop_count = 0;
+    double wakeup_sum_ns = 0;
+    uint64_t max_wakeup_ns = 0;
+
+    while (m_is_running)
+    {
+        uint64_t tick_ns = std::min_element(states.begin(), states.end(), [](const auto& a, const auto& b) {
+                               return a.deadline_ns < b.deadline_ns;
+                           })->deadline_ns;
+        struct timespec deadline {static_cast<time_t>(tick_ns / 1'000'000'000),
+                                  static_cast<long>(tick_ns % 1'000'000'000)};
+
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR && m_is_running)
+        {
+        }
+        if (!m_is_running)
+        {
+            break;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t now_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+        uint64_t wakeup_ns = now_ns > tick_ns ? now_ns - tick_ns : 0;
+        wakeup_sum_ns += wakeup_ns;
+        max_wakeup_ns = std::max(max_wakeup_ns, wakeup_ns);
+        tick_count++;
+
+        // Everything due by now goes out in one batch, messages that became due while waking up included
+        unsigned int count = 0;
+        for (size_t i = 0; i < m_schedule.size(); i++)
+        {
+            if (states[i].deadline_ns > now_ns)
+            {
+                continue;
+            }
+
+            const ScheduledMessage& message = m_schedule[i];
+            canfd_frame& frame = m_tx_frames[count];
+            frame.can_id = message.can_id;
+            frame.len = static_cast<__u8>(message.length);
+            frame.flags = (m_options.is_fd && m_options.use_brs) ? CANFD_BRS : 0;
+            fill_payload(frame, states[i].sent_count, message.pattern, message.fixed_payload);
+            due[count++] = i;
+        }
+
+        sent_count += send_batch(count, backpressure_count, drop_count);
+
+        for (unsigned int j = 0; j < count; j++)
+        {
+            MessageState& state = states[due[j]];
+            const uint64_t period_ns = m_schedule[due[j]].period_ns;
+
+            if (state.sent_count > 0)
+            {
+                uint64_t period = now_ns - state.last_sent_ns;
+                double jitter = static_cast<double>(period) - static_cast<double>(period_ns);
+                state.min_period_ns = std::min(state.min_period_ns, period);
+                state.max_period_ns = std::max(state.max_period_ns, period);
+                state.jitter_sum_ns += std::fabs(jitter);
+                state.jitter_square_sum_ns += jitter * jitter;
+            }
+            state.last_sent_ns = now_ns;
+            state.sent_count++;
+
+            // Deadlines stay on the original grid, periods missed entirely are skipped and counted
+            state.deadline_ns += period_ns;
+            if (state.deadline_ns <= now_ns)
+            {
+                uint64_t missed = (now_ns - state.deadline_ns) / period_ns + 1;
+                state.overrun_count += missed;
+                state.deadline_ns += missed * period_ns;
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = (static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec - start_ns) / 1e9;
+
+    std::cout << "Sent " << sent_count << " scheduled frame(s) in " << tick_count << " tick(s) over " << elapsed
+              << " s, dropped " << drop_count << ", backpressure waits " << backpressure_count << std::endl;
+    if (tick_count > 0)
+    {
+        std::cout << "Wake-up latency: mean " << wakeup_sum_ns / tick_count / 1000 << " us, max "
+                  << max_wakeup_ns / 1000.0 << " us" << std::endl;
+    }
+
+    for (size_t i = 0; i < m_schedule.size(); i++)
+    {
+        const MessageState& state = states[i];
+        const ScheduledMessage& message = m_schedule[i];
+
+        std::cout << "  ID=0x" << std::hex << std::uppercase << (message.can_id & CAN_EFF_MASK) << std::dec
+                  << " every " << message.period_ns / 1e6 << " ms: sent " << state.sent_count;
+        if (state.sent_count > 1)
+        {
+            uint64_t periods = state.sent_count - 1;
+            std::cout << ", period " << state.min_period_ns / 1e6 << "-" << state.max_period_ns / 1e6
+                      << " ms, jitter mean " << state.jitter_sum_ns / periods / 1000 << " us, rms "
+                      << std::sqrt(state.jitter_square_sum_ns / periods) / 1000 << " us";
+        }
+        std::cout << ", overruns " << state.overrun_count << std::endl;
+    }
+}
+
+void CanSender::run_messages(const char* protocol, const std::function<ssize_t(const uint8_t*, size_t)>& send)
+{
+    const double rate = m_options.is_generator ? m_options.generator_rate : 1.0;
+    std::vector<uint8_t> payload(m_options.payload_length);
+
+    for (size_t i = 0; i < payload.size(); i++)
+    {
+        payload[i] = static_cast<uint8_t>(i);
+    }
+
+    std::cout << "Sending " << payload.size() << " byte " << protocol << " messages";
+    if (rate > 0)
+    {
+        std::cout << " at " << rate << " messages/s" << std::endl;
+    }
+    else
+    {
+        std::cout << " as fast as the receiver accepts them" << std::endl;
+    }
+
+    const uint64_t period_ns = rate > 0 ? static_cast<uint64_t>(std::llround(1e9 / rate)) : 0;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const uint64_t start_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+    uint64_t deadline_ns = start_ns;
+    uint64_t last_report_ns = start_ns;
+
+    uint64_t message_count = 0;
+    uint64_t byte_count = 0;
+    uint64_t interval_byte_count = 0;
+    uint64_t failure_count = 0;
+
+    while (m_is_running)
+    {
+        // Sending as fast as possible never waits, answer the claim traffic that queued up meanwhile
+        if (period_ns == 0 && !wait_for_message_slot(0))
+        {
+            break;
+        }
+
+        // Message counter in the first bytes so the receiver can tell messages apart
+        uint64_t counter = message_count;
+        for (size_t i = 0; i < payload.size() && i < sizeof(counter); i++)
+        {
+            payload[i] = static_cast<uint8_t>(counter >> (8 * i));
+        }
+
+        ssize_t sent = send(payload.data(), payload.size());
+        if (sent < 0)
+        {
+            if (errno != EINTR)
+            {
+                // ISO-TP reports ECOMM when no flow control frame arrived from a receiver
+                std::cerr << "Error sending " << protocol << " message: " << std::strerror(errno) << std::endl;
+                failure_count++;
+            }
+        }
+        else
+        {
+            message_count++;
+            byte_count += static_cast<uint64_t>(sent);
+            interval_byte_count += static_cast<uint64_t>(sent);
+        }
+
+        if (period_ns > 0)
+        {
+            deadline_ns += period_ns;
+            if (!wait_for_message_slot(deadline_ns))
+            {
+                break;
+            }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t now_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+        if (now_ns - last_report_ns >= 1'000'000'000)
+        {
+            double interval = (now_ns - last_report_ns) / 1e9;
+            std::cout << "Sent " << message_count << " message(s), " << interval_byte_count / interval / 1000
+                      << " KB/s" << std::endl;
+            interval_byte_count = 0;
+            last_report_ns = now_ns;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = (static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec - start_ns) / 1e9;
+
+    std::cout << "Sent " << message_count << " " << protocol << " message(s) of " << payload.size() << " bytes in "
+              << elapsed << " s (" << (elapsed > 0 ? byte_count / elapsed / 1000 : 0.0) << " KB/s), failed "
+              << failure_count << std::endl;
+}
+
+bool CanSender::wait_for_message_slot(uint64_t deadline_ns)
+{
+    struct timespec deadline {static_cast<time_t>(deadline_ns / 1'000'000'000),
+                              static_cast<long>(deadline_ns % 1'000'000'000)};
+    struct pollfd fd {m_options.use_j1939 ? m_j1939.claim_socket() : -1, POLLIN, 0};
+
+    if (fd.fd < 0)
+    {
+        if (deadline_ns > 0)
+        {
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+        }
+        return true;
+    }
+
+    // J1939-81: while sending, defend the claimed address against contending claims and answer requests for it.
+    // The claim socket is waited on instead of sleeping, so the answers do not wait for the next message.
+    while (m_is_running)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t now_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+        uint64_t remaining_ns = deadline_ns > now_ns ? deadline_ns - now_ns : 0;
+        struct timespec timeout {static_cast<time_t>(remaining_ns / 1'000'000'000),
+                                 static_cast<long>(remaining_ns % 1'000'000'000)};
+
+        int ready = ppoll(&fd, 1, &timeout, nullptr);
+        if (ready < 0 && errno != EINTR)
+        {
+            perror("Error waiting for J1939 claims");
+            return false;
+        }
+
+        if (ready > 0)
+        {
+            m_j1939.service_claims();
+            fd.fd = m_j1939.claim_socket();
+            if (m_j1939.address() > J1939_MAX_UNICAST_ADDR)
+            {
+                std::cerr << "Error: lost the J1939 address, stopping" << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        if (remaining_ns == 0)
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+void CanSender::send_isotp_end_message()
+{
+    static const uint8_t end_message[] = {'E', 'N', 'D'};
+
+    std::cout << "Sending END message over ISO-TP" << std::endl;
+
+    if (m_isotp.send(end_message, sizeof(end_message)) < 0)
+    {
+        perror("Error sending ISO-TP END message");
+    }
+}
+
+void CanSender::run_bcm()
+{
+    std::vector<canfd_frame> frames(m_options.bcm_jobs.size(), canfd_frame {});
+
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        const BcmJob& job = m_options.bcm_jobs[i];
+        canfd_frame& frame = frames[i];
+
+        frame.can_id = job.can_id;
+        frame.len = static_cast<__u8>(m_options.payload_length);
+        frame.flags = (m_options.is_fd && m_options.use_brs) ? CANFD_BRS : 0;
+        fill_payload(frame, 0, m_options.pattern, m_options.fixed_payload);
+
+        if (m_bcm.start_cyclic(frame, m_options.is_fd, job.period_us))
+        {
+            std::cerr << "Failed to start cyclic message 0x" << std::hex << std::uppercase
+                      << (job.can_id & CAN_EFF_MASK) << std::dec << std::endl;
+            return;
+        }
+
+        std::cout << "Cyclic: ID=0x" << std::hex << std::uppercase << (job.can_id & CAN_EFF_MASK) << std::dec
+                  << " every " << job.period_us / 1000.0 << " ms" << std::endl;
+    }
+
+    // The kernel sends the frames, this thread only wakes up to refresh their payloads
+    uint64_t update_count = 0;
+    while (m_is_running)
+    {
+        sleep(1);
+        if (!m_is_running)
+        {
+            break;
+        }
+
+        update_count++;
+        for (canfd_frame& frame : frames)
+        {
+            fill_payload(frame, update_count, m_options.pattern, m_options.fixed_payload);
+            m_bcm.update(frame, m_options.is_fd);
+        }
+    }
+
+    for (const canfd_frame& frame : frames)
+    {
+        m_bcm.stop_cyclic(frame.can_id, m_options.is_fd);
+    }
+
+    double frames_per_second = 0;
+    for (const BcmJob& job : m_options.bcm_jobs)
+    {
+        frames_per_second += 1e6 / job.period_us;
+    }
+
+    std::cout << "Stopped " << frames.size() << " cyclic message(s) at " << frames_per_second
+              << " frames/s in total after " << update_count << " payload update(s)" << std::endl;
+}
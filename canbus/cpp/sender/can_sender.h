@@ -18,31 +18,158 @@
 #ifndef CAN_SENDER_H
 #define CAN_SENDER_H
 
+#include "bcm_socket.h"
+#include "can_capture.h"
+#include "isotp_socket.h"
+#include "j1939_socket.h"
+#include "realtime.h"
+#include "tx_latency.h"
+#include "uring_queue.h"
 #include <linux/can.h>
 #include <linux/can/raw.h>
+#include <net/if.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <sys/socket.h>
+#include <vector>
+
+enum class PayloadPattern
+{
+    Counter,   // Little-endian frame counter
+    Random,    // xorshift pseudo-random bytes
+    Timestamp, // Little-endian CLOCK_REALTIME nanoseconds when the frame is queued, for latency measurements
+    Fixed,     // CanSenderOptions::fixed_payload repeated
+};
+
+// One cyclic message of the broadcast manager mode
+struct BcmJob
+{
+    canid_t can_id;
+    uint64_t period_us;
+};
+
+// One periodic message of the schedule table mode
+struct ScheduledMessage
+{
+    canid_t can_id;
+    uint64_t period_ns;
+    uint64_t offset_ns; // First send after the start of the schedule
+    unsigned int length;
+    PayloadPattern pattern;
+    std::vector<uint8_t> fixed_payload;
+};
+
+struct CanSenderOptions
+{
+    bool is_fd {false};               // Send CAN FD frames (interface MTU must be CANFD_MTU)
+    bool use_brs {false};             // Switch to the data bitrate for the payload of CAN FD frames
+    unsigned int payload_length {8};  // Bytes per data frame, up to CANFD_MAX_DLEN in CAN FD mode
+
+    // Retransmit a binary capture or candump log instead of the synthetic MSG_nnn frames
+    std::string replay_path {};
+    double replay_speed {1.0}; // Time scale of the replay, 0 sends as fast as possible
+
+    // Load generator, sends to generator_ids round-robin in sendmmsg() batches
+    bool is_generator {false};
+    double generator_rate {0};  // Frames per second, 0 sends as fast as the bus accepts
+    std::vector<canid_t> generator_ids {0x123};
+    PayloadPattern pattern {PayloadPattern::Counter};
+    std::vector<uint8_t> fixed_payload {};
+    unsigned int batch_size {32}; // Frames per sendmmsg() call
+    bool use_io_uring {false};    // Submit generator batches as linked io_uring sends instead of sendmmsg()
+
+    // Send the periodic messages of a schedule table file from the sending thread, every message due at a tick in
+    // one sendmmsg() batch. Each line holds a hex ID, period and offset in ms, payload pattern and optional length.
+    std::string schedule_path {};
+
+    // Hand cyclic messages to the kernel broadcast manager, which sends each at its own period. The payloads are
+    // refreshed in place once per second from pattern.
+    std::vector<BcmJob> bcm_jobs {};
+
+    // Send payload_length byte messages over ISO-TP instead of single frames, one per second or at generator_rate
+    // messages per second with the generator enabled
+    bool use_isotp {false};
+    IsoTpOptions isotp {};
+
+    // Send payload_length byte messages (up to J1939_MAX_PAYLOAD) of one PGN, paced like ISO-TP messages.
+    // Longer than 8 bytes the kernel runs a transport protocol session, BAM when sent to the global address.
+    bool use_j1939 {false};
+    J1939Options j1939 {};
+    pgn_t j1939_pgn {0};
+    uint8_t j1939_destination {J1939_NO_ADDR};
+
+    // Match every frame sent on the raw socket with its TX timestamp and its confirmation by the controller, and
+    // print per-ID latency percentiles on exit
+    bool measure_tx_latency {false};
+
+    // With measure_tx_latency, switch the interface to hardware timestamping (SIOCSHWTSTAMP) for the periods
+    // between hardware TX timestamps. Changes the interface for all its users and needs CAP_NET_ADMIN, the previous
+    // setting is restored on exit.
+    bool use_hw_timestamps {false};
+
+    // Scheduling, CPU affinity and memory locking of the sending thread
+    RealtimeOptions realtime {};
+};
 
 class CanSender
 {
   public:
-    CanSender(std::string_view interface_name);
+    CanSender(std::string_view interface_name, const CanSenderOptions& options = {});
     ~CanSender();
 
+    CanSender(const CanSender&) = delete;
+    CanSender& operator=(const CanSender&) = delete;
+
+    static bool is_valid_length(unsigned int length, bool is_fd);
+    static bool parse_pattern(const std::string& text, PayloadPattern& pattern, std::vector<uint8_t>& fixed_payload);
+
     int initialize();
     void run();
     void stop();
 
   private:
     std::string m_interface_name {};
+    CanSenderOptions m_options {};
     int m_socket {-1};
     volatile bool m_is_running {false};
     unsigned int m_frame_index {0};
+    std::vector<CaptureRecord> m_replay_records {};
+    std::vector<ScheduledMessage> m_schedule {};
+
+    // Preallocated transmit batch for sendmmsg()
+    std::vector<canfd_frame> m_tx_frames {};
+    std::vector<struct iovec> m_tx_iovecs {};
+    std::vector<struct mmsghdr> m_tx_messages {};
+    uint64_t m_random_state {0x9E3779B97F4A7C15};
+    IsoTpSocket m_isotp {};
+    J1939Socket m_j1939 {};
+    BcmSocket m_bcm {};
+    UringQueue m_uring {};
+    std::unique_ptr<TxLatency> m_tx_latency {};
 
     int setup_socket();
     int bind_socket();
-    int send_frame(const can_frame& frame);
+    int enable_fd_frames(const struct ifreq& ifr);
+    int send_frame(const canfd_frame& frame, bool is_fd);
     void send_data_frame();
     void send_end_frame();
+    int load_replay();
+    int load_candump_log(const std::string& path);
+    void run_replay();
+    void setup_tx_batch(unsigned int batch_size);
+    void fill_payload(canfd_frame& frame, uint64_t counter, PayloadPattern pattern,
+                      const std::vector<uint8_t>& fixed_payload);
+    unsigned int send_batch(unsigned int count, uint64_t& backpressure_count, uint64_t& drop_count);
+    unsigned int send_uring_batch(unsigned int count, uint64_t& backpressure_count, uint64_t& drop_count);
+    void run_generator();
+    int load_schedule();
+    void run_schedule();
+    void run_messages(const char* protocol, const std::function<ssize_t(const uint8_t*, size_t)>& send);
+    bool wait_for_message_slot(uint64_t deadline_ns);
+    void send_isotp_end_message();
+    void run_bcm();
 };
 
 #endif // CAN_SENDER_H
@@ -16,9 +16,15 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "can_sender.h"
+#include "hex_parse.h"
+#include <cstdlib>
+#include <getopt.h>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <signal.h>
+#include <sstream>
+#include <string>
 
 // Global variables
 static std::unique_ptr<CanSender> g_sender;
@@ -32,27 +38,372 @@ void signal_handler([[maybe_unused]] int sig)
     }
 }
 
+// Parses a comma separated list of hex CAN IDs, IDs above 0x7FF are sent as extended frames
+bool parse_ids(const std::string& text, std::vector<canid_t>& ids)
+{
+    std::stringstream stream {text};
+    std::string item;
+
+    ids.clear();
+    while (std::getline(stream, item, ','))
+    {
+        char* end;
+        unsigned long id = std::strtoul(item.c_str(), &end, 16);
+        if (item.empty() || *end != '\0' || id > CAN_EFF_MASK)
+        {
+            return false;
+        }
+        ids.push_back(id > CAN_SFF_MASK ? static_cast<canid_t>(id) | CAN_EFF_FLAG : static_cast<canid_t>(id));
+    }
+
+    return !ids.empty();
+}
+
+// Parses a comma separated list of "ID@MS", hex CAN IDs each sent every MS milliseconds (fractions allowed)
+bool parse_bcm_jobs(const std::string& text, std::vector<BcmJob>& jobs)
+{
+    std::stringstream stream {text};
+    std::string item;
+
+    while (std::getline(stream, item, ','))
+    {
+        char* end;
+        unsigned long id = std::strtoul(item.c_str(), &end, 16);
+        if (end == item.c_str() || *end != '@' || id > CAN_EFF_MASK)
+        {
+            return false;
+        }
+
+        const char* period_text = end + 1;
+        double period_ms = std::strtod(period_text, &end);
+        if (end == period_text || *end != '\0' || period_ms < 0.001)
+        {
+            return false;
+        }
+
+        canid_t can_id = id > CAN_SFF_MASK ? static_cast<canid_t>(id) | CAN_EFF_FLAG : static_cast<canid_t>(id);
+        jobs.push_back({can_id, static_cast<uint64_t>(period_ms * 1000.0 + 0.5)});
+    }
+
+    return !jobs.empty();
+}
+
+// Parses "PGN" or "PGN:DA" in hex, without a destination messages go to the global address
+bool parse_j1939_target(const std::string& text, CanSenderOptions& options)
+{
+    char* end;
+    unsigned long pgn = std::strtoul(text.c_str(), &end, 16);
+    if (end == text.c_str() || pgn > J1939_PGN_MAX)
+    {
+        return false;
+    }
+
+    options.j1939_pgn = static_cast<pgn_t>(pgn);
+    options.j1939_destination = J1939_NO_ADDR;
+
+    if (*end == ':')
+    {
+        const char* destination_text = end + 1;
+        unsigned long destination = std::strtoul(destination_text, &end, 16);
+        if (end == destination_text || destination > J1939_NO_ADDR)
+        {
+            return false;
+        }
+        options.j1939_destination = static_cast<uint8_t>(destination);
+    }
+
+    return *end == '\0';
+}
+
 void print_usage(std::string_view program_name)
 {
-    std::cout << "Usage: " << program_name << " [OPTIONS]" << std::endl;
+    std::cout << "Usage: " << program_name << " [OPTIONS] DEVICE" << std::endl;
     std::cout << "Options:" << std::endl;
-    std::cout << "  DEVICE    CAN bus interface name" << std::endl;
+    std::cout << "  DEVICE              CAN bus interface name" << std::endl;
+    std::cout << "  -f, --fd            Send CAN FD frames (interface MTU must be 72)" << std::endl;
+    std::cout << "  -B, --brs           Use bit rate switching for CAN FD frames" << std::endl;
+    std::cout << "  -l, --length N      Payload length in bytes (default: 8, or 64 with --fd)" << std::endl;
+    std::cout << "  -R, --replay FILE   Replay a binary capture or candump log at its original timing" << std::endl;
+    std::cout << "  -s, --speed X       Replay speed factor, e.g. 2 or 10, or 'max' (default: 1)" << std::endl;
+    std::cout << "  -g, --generate RATE Generate load at RATE frames/s, or 'max' to saturate the bus" << std::endl;
+    std::cout << "  -I, --ids LIST      Comma separated hex IDs for the generator (default: 123)" << std::endl;
+    std::cout << "  -p, --pattern P     Payload: counter, random, timestamp or fixed:HEX (default: counter)"
+              << std::endl;
+    std::cout << "  -b, --batch N       Generator frames per sendmmsg() call (default: 32)" << std::endl;
+    std::cout << "  -U, --io-uring      Submit generator batches through io_uring" << std::endl;
+    std::cout << "  -t, --schedule FILE Send the periodic messages of a schedule table, lines of hex ID, period and"
+              << std::endl;
+    std::cout << "                      offset in ms, pattern and optional length, e.g. '100 10 2.5 counter 8'"
+              << std::endl;
+    std::cout << "  -C, --cyclic LIST   Kernel-timed cyclic frames, comma separated hex ID@MS, e.g. 100@10,200@2.5"
+              << std::endl;
+    std::cout << "  -i, --isotp TX:RX   Send -l byte messages (up to 4095) over ISO-TP with hex IDs TX and RX"
+              << std::endl;
+    std::cout << "  -x, --padding HEX   Pad ISO-TP frames to full length with byte HEX" << std::endl;
+    std::cout << "  -J, --j1939 PGN[:DA] Send -l byte messages (up to 1785) of hex PGN over J1939, to DA or global"
+              << std::endl;
+    std::cout << "  -N, --name HEX      J1939 NAME to claim an address with" << std::endl;
+    std::cout << "  -A, --address HEX   Preferred J1939 address with --name, otherwise the static source address"
+              << std::endl;
+    std::cout << "  -T, --tx-latency    Measure per-ID latency from queuing to TX timestamp and confirmation"
+              << std::endl;
+    std::cout << "  -H, --hw-timestamps With -T, also switch the interface to hardware TX timestamps" << std::endl;
+    std::cout << "  -S, --sched POLICY  Sending thread scheduling: fifo:PRIO, rr:PRIO or other" << std::endl;
+    std::cout << "  -a, --affinity CPU  Pin the sending thread to CPU" << std::endl;
+    std::cout << "  -L, --lock-memory   Lock memory and prefault the transmit batch" << std::endl;
+    std::cout << "  -h, --help          Show this help message" << std::endl;
     std::cout << std::endl << "Example: " << program_name << " vcan0" << std::endl;
+    std::cout << "         " << program_name << " --fd --brs -l 64 vcan0" << std::endl;
+    std::cout << "         " << program_name << " -R vcan0.cap -s 10 vcan0" << std::endl;
+    std::cout << "         " << program_name << " -g max -I 100,101,1ABCDEF0 -p random vcan0" << std::endl;
+    std::cout << "         " << program_name << " -g max -b 64 -U vcan0" << std::endl;
+    std::cout << "         " << program_name << " -g 2000 -S fifo:80 -a 3 -L can0" << std::endl;
+    std::cout << "         " << program_name << " -g 1000 -I 100,200 -T can0" << std::endl;
+    std::cout << "         " << program_name << " -t ecu.schedule -S fifo:80 -L can0" << std::endl;
+    std::cout << "         " << program_name << " -C 100@10,101@20,18FEF100@100 -p random vcan0" << std::endl;
+    std::cout << "         " << program_name << " -i 7E0:7E8 -l 4095 -g max vcan0" << std::endl;
+    std::cout << "         " << program_name << " -J FEF1 -A 20 -l 100 -g 10 vcan0" << std::endl;
 }
 
 int main(int argc, char* argv[])
 {
+    CanSenderOptions options {};
+    int payload_length = -1;
+    int opt;
+    static struct option long_options[] = {{"fd", no_argument, 0, 'f'},
+                                           {"brs", no_argument, 0, 'B'},
+                                           {"length", required_argument, 0, 'l'},
+                                           {"replay", required_argument, 0, 'R'},
+                                           {"speed", required_argument, 0, 's'},
+                                           {"generate", required_argument, 0, 'g'},
+                                           {"ids", required_argument, 0, 'I'},
+                                           {"pattern", required_argument, 0, 'p'},
+                                           {"batch", required_argument, 0, 'b'},
+                                           {"io-uring", no_argument, 0, 'U'},
+                                           {"schedule", required_argument, 0, 't'},
+                                           {"cyclic", required_argument, 0, 'C'},
+                                           {"isotp", required_argument, 0, 'i'},
+                                           {"padding", required_argument, 0, 'x'},
+                                           {"j1939", required_argument, 0, 'J'},
+                                           {"name", required_argument, 0, 'N'},
+                                           {"address", required_argument, 0, 'A'},
+                                           {"tx-latency", no_argument, 0, 'T'},
+                                           {"hw-timestamps", no_argument, 0, 'H'},
+                                           {"sched", required_argument, 0, 'S'},
+                                           {"affinity", required_argument, 0, 'a'},
+                                           {"lock-memory", no_argument, 0, 'L'},
+                                           {"help", no_argument, 0, 'h'},
+                                           {0, 0, 0, 0}};
+
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
-    if (argc < 2)
+    while ((opt = getopt_long(argc, argv, "fBl:R:s:g:I:p:b:Ut:C:i:x:J:N:A:THS:a:Lh", long_options, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+        case 'f':
+            options.is_fd = true;
+            break;
+        case 'B':
+            options.use_brs = true;
+            break;
+        case 'l':
+            payload_length = std::atoi(optarg);
+            if (payload_length < 0)
+            {
+                std::cerr << "Invalid payload length: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'R':
+            options.replay_path = optarg;
+            break;
+        case 's':
+            options.replay_speed = std::string_view {optarg} == "max" ? 0.0 : std::atof(optarg);
+            if (options.replay_speed <= 0 && std::string_view {optarg} != "max")
+            {
+                std::cerr << "Invalid replay speed: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'g':
+            options.is_generator = true;
+            options.generator_rate = std::string_view {optarg} == "max" ? 0.0 : std::atof(optarg);
+            if (options.generator_rate <= 0 && std::string_view {optarg} != "max")
+            {
+                std::cerr << "Invalid generator rate: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'I':
+            if (!parse_ids(optarg, options.generator_ids))
+            {
+                std::cerr << "Invalid ID list: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'p':
+            if (!CanSender::parse_pattern(optarg, options.pattern, options.fixed_payload))
+            {
+                std::cerr << "Invalid payload pattern: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'b':
+        {
+            int batch_size = std::atoi(optarg);
+            if (batch_size <= 0)
+            {
+                std::cerr << "Invalid batch size: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.batch_size = static_cast<unsigned int>(batch_size);
+            break;
+        }
+        case 'U':
+            options.use_io_uring = true;
+            break;
+        case 't':
+            options.schedule_path = optarg;
+            break;
+        case 'C':
+            if (!parse_bcm_jobs(optarg, options.bcm_jobs))
+            {
+                std::cerr << "Invalid cyclic message list: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'i':
+            if (!parse_isotp_ids(optarg, options.isotp))
+            {
+                std::cerr << "Invalid ISO-TP IDs: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.use_isotp = true;
+            break;
+        case 'x':
+        {
+            uint64_t padding_byte;
+            if (!parse_hex(optarg, 0xFF, padding_byte))
+            {
+                std::cerr << "Invalid padding byte: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.isotp.use_padding = true;
+            options.isotp.padding_byte = static_cast<uint8_t>(padding_byte);
+            break;
+        }
+        case 'T':
+            options.measure_tx_latency = true;
+            break;
+        case 'H':
+            options.use_hw_timestamps = true;
+            break;
+        case 'S':
+            if (!parse_scheduling(optarg, options.realtime))
+            {
+                std::cerr << "Invalid scheduling: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'a':
+            if (!parse_cpu_list(optarg, options.realtime.cpus))
+            {
+                std::cerr << "Invalid CPU list: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'L':
+            options.realtime.lock_memory = true;
+            break;
+        case 'J':
+            if (!parse_j1939_target(optarg, options))
+            {
+                std::cerr << "Invalid J1939 PGN: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.use_j1939 = true;
+            break;
+        case 'N':
+        {
+            uint64_t name;
+            if (!parse_hex(optarg, std::numeric_limits<name_t>::max(), name))
+            {
+                std::cerr << "Invalid J1939 NAME: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.j1939.name = static_cast<name_t>(name);
+            break;
+        }
+        case 'A':
+        {
+            uint64_t address;
+            if (!parse_hex(optarg, J1939_MAX_UNICAST_ADDR, address))
+            {
+                std::cerr << "Invalid J1939 address: " << optarg << std::endl;
+                return EXIT_FAILURE;
+            }
+            options.j1939.address = static_cast<uint8_t>(address);
+            break;
+        }
+        case 'h':
+            print_usage(argv[0]);
+            return EXIT_SUCCESS;
+        default:
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc)
     {
         print_usage(argv[0]);
         return EXIT_FAILURE;
     }
 
-    std::string_view interface_name = argv[1];
-    g_sender = std::make_unique<CanSender>(interface_name);
+    if (options.use_brs && !options.is_fd)
+    {
+        std::cerr << "--brs requires --fd" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (options.use_j1939)
+    {
+        options.payload_length = payload_length >= 0 ? payload_length : CAN_MAX_DLEN;
+        if (options.payload_length == 0 || options.payload_length > J1939_MAX_PAYLOAD)
+        {
+            std::cerr << "Invalid J1939 message length " << options.payload_length << " (1-" << J1939_MAX_PAYLOAD
+                      << ")" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    else if (options.use_isotp)
+    {
+        options.isotp.is_fd = options.is_fd;
+        options.payload_length = payload_length >= 0 ? payload_length : CANFD_MAX_DLEN;
+        if (options.payload_length == 0 || options.payload_length > ISOTP_MAX_PAYLOAD)
+        {
+            std::cerr << "Invalid ISO-TP message length " << options.payload_length << " (1-" << ISOTP_MAX_PAYLOAD
+                      << ")" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        options.payload_length =
+            payload_length >= 0 ? payload_length : (options.is_fd ? CANFD_MAX_DLEN : CAN_MAX_DLEN);
+    }
+
+    if (!options.use_isotp && !options.use_j1939 && !CanSender::is_valid_length(options.payload_length, options.is_fd))
+    {
+        std::cerr << "Invalid payload length " << options.payload_length << " for "
+                  << (options.is_fd ? "CAN FD (0-8, 12, 16, 20, 24, 32, 48, 64)" : "classic CAN (0-8)") << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string_view interface_name = argv[optind];
+    g_sender = std::make_unique<CanSender>(interface_name, options);
 
     if (g_sender->initialize())
     {
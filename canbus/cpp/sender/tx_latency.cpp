@@ -0,0 +1,272 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tx_latency.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <linux/can/raw.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <poll.h>
+#include <time.h>
+
+static_assert(sizeof(struct scm_timestamping) == 3 * sizeof(struct timespec), "ControlBuffer is sized for it");
+
+// Frames skipped at most when matching a report, more means it belongs to none of the frames in flight
+static constexpr uint64_t MAX_SKIP = 256;
+
+TxLatency::TxLatency()
+    : m_pending(PENDING_CAPACITY), m_frames(RECEIVE_BATCH), m_controls(RECEIVE_BATCH), m_iovecs(RECEIVE_BATCH),
+      m_messages(RECEIVE_BATCH)
+{
+    for (size_t i = 0; i < RECEIVE_BATCH; i++)
+    {
+        m_iovecs[i].iov_base = &m_frames[i];
+        m_iovecs[i].iov_len = sizeof(canfd_frame);
+
+        std::memset(&m_messages[i], 0, sizeof(struct mmsghdr));
+        m_messages[i].msg_hdr.msg_iov = &m_iovecs[i];
+        m_messages[i].msg_hdr.msg_iovlen = 1;
+        m_messages[i].msg_hdr.msg_control = m_controls[i].data;
+    }
+}
+
+int TxLatency::setup(int socket, const std::string& interface_name, bool use_hw_timestamps)
+{
+    int enable = 1;
+    if (setsockopt(socket, SOL_CAN_RAW, CAN_RAW_RECV_OWN_MSGS, &enable, sizeof(enable)) < 0)
+    {
+        perror("Error enabling reception of own frames");
+        return 1;
+    }
+
+    // Ask the controller to timestamp sent frames, most CAN drivers do not support this
+    if (use_hw_timestamps)
+    {
+        m_has_hw_timestamps = enable_hw_timestamps(socket, interface_name, true, m_saved_hw_timestamps);
+        if (!m_has_hw_timestamps)
+        {
+            perror("Warning: hardware timestamps not available");
+        }
+    }
+
+    // TX timestamps come back on the error queue with a copy of the frame, the echoes carry RX timestamps
+    int flags = SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_TX_HARDWARE | SOF_TIMESTAMPING_RX_SOFTWARE |
+                SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    if (setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0)
+    {
+        perror("Error enabling TX timestamps");
+        return 1;
+    }
+
+    std::cout << "Measuring TX latency with software timestamps"
+              << (m_has_hw_timestamps ? ", TX periods with hardware timestamps" : "") << std::endl;
+
+    return 0;
+}
+
+void TxLatency::restore(int socket)
+{
+    if (m_has_hw_timestamps)
+    {
+        restore_hw_timestamps(socket, m_saved_hw_timestamps);
+        m_has_hw_timestamps = false;
+    }
+}
+
+void TxLatency::add_sent(canid_t can_id, uint64_t queued_ns)
+{
+    m_pending[m_sent_count & (PENDING_CAPACITY - 1)] = {can_id, queued_ns};
+    m_sent_count++;
+    m_entries[can_id].sent_count++;
+}
+
+void TxLatency::collect(int socket)
+{
+    while (receive(socket, MSG_DONTWAIT))
+    {
+    }
+
+    while (receive(socket, MSG_DONTWAIT | MSG_ERRQUEUE))
+    {
+    }
+}
+
+// Returns true when the batch was full and more may be waiting
+bool TxLatency::receive(int socket, int flags)
+{
+    for (struct mmsghdr& message : m_messages)
+    {
+        message.msg_hdr.msg_controllen = sizeof(ControlBuffer::data);
+    }
+
+    int count = recvmmsg(socket, m_messages.data(), RECEIVE_BATCH, flags, nullptr);
+    if (count <= 0)
+    {
+        return false;
+    }
+
+    bool is_error_queue = flags & MSG_ERRQUEUE;
+    for (int i = 0; i < count; i++)
+    {
+        const struct msghdr& message = m_messages[i].msg_hdr;
+
+        // The socket also receives the frames of other nodes, own frames are flagged
+        if (!is_error_queue && !(message.msg_flags & MSG_CONFIRM))
+        {
+            continue;
+        }
+
+        match(is_error_queue ? m_driver : m_confirmed, m_frames[i].can_id, message, is_error_queue);
+    }
+
+    return count == static_cast<int>(RECEIVE_BATCH);
+}
+
+void TxLatency::match(Stream& stream, canid_t can_id, const struct msghdr& message, bool is_driver)
+{
+    struct timespec timestamp {};
+    struct timespec hw_timestamp {};
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(const_cast<struct msghdr*>(&message), cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPING)
+        {
+            // ts[0] is the software timestamp on CLOCK_REALTIME like queued_ns, ts[2] the raw hardware one
+            struct scm_timestamping timestamps;
+            std::memcpy(&timestamps, CMSG_DATA(cmsg), sizeof(timestamps));
+            timestamp = timestamps.ts[0];
+            hw_timestamp = timestamps.ts[2];
+        }
+        else if (cmsg->cmsg_level == SOL_CAN_RAW && cmsg->cmsg_type == SCM_CAN_RAW_ERRQUEUE)
+        {
+            // Only the timestamp of the frame being sent, not of entering the queueing discipline
+            struct sock_extended_err error;
+            std::memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+            if (error.ee_origin != SO_EE_ORIGIN_TIMESTAMPING || error.ee_info != SCM_TSTAMP_SND)
+            {
+                return;
+            }
+        }
+    }
+
+    // Frames overwritten in the pending ring before being reported
+    if (m_sent_count - stream.cursor > PENDING_CAPACITY)
+    {
+        stream.missed_count += m_sent_count - PENDING_CAPACITY - stream.cursor;
+        stream.cursor = m_sent_count - PENDING_CAPACITY;
+    }
+
+    uint64_t end = std::min(m_sent_count, stream.cursor + MAX_SKIP);
+    for (uint64_t i = stream.cursor; i < end; i++)
+    {
+        const Pending& pending = m_pending[i & (PENDING_CAPACITY - 1)];
+        if (pending.can_id != can_id)
+        {
+            continue;
+        }
+
+        stream.missed_count += i - stream.cursor;
+        stream.cursor = i + 1;
+
+        Entry& entry = m_entries[can_id];
+        uint64_t wire_ns = static_cast<uint64_t>(timestamp.tv_sec) * 1'000'000'000 + timestamp.tv_nsec;
+        if (wire_ns != 0 && wire_ns >= pending.queued_ns)
+        {
+            (is_driver ? entry.driver : entry.confirmed).add(wire_ns - pending.queued_ns);
+        }
+
+        uint64_t hw_ns = static_cast<uint64_t>(hw_timestamp.tv_sec) * 1'000'000'000 + hw_timestamp.tv_nsec;
+        if (is_driver && hw_ns != 0)
+        {
+            if (entry.last_hw_ns != 0 && hw_ns > entry.last_hw_ns)
+            {
+                entry.hw_period.add(hw_ns - entry.last_hw_ns);
+            }
+            entry.last_hw_ns = hw_ns;
+        }
+        return;
+    }
+}
+
+void TxLatency::finish(int socket, int timeout_ms)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t deadline_ms = static_cast<int64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1'000'000 + timeout_ms;
+
+    while (m_confirmed.cursor < m_sent_count)
+    {
+        collect(socket);
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t remaining_ms = deadline_ms - (static_cast<int64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1'000'000);
+        if (remaining_ms <= 0)
+        {
+            break;
+        }
+
+        struct pollfd pfd {socket, POLLIN, 0};
+        if (poll(&pfd, 1, static_cast<int>(remaining_ms)) < 0 && errno != EINTR)
+        {
+            break;
+        }
+    }
+
+    collect(socket);
+}
+
+void TxLatency::report(std::ostream& out) const
+{
+    std::vector<canid_t> ids;
+    ids.reserve(m_entries.size());
+    for (const auto& [can_id, entry] : m_entries)
+    {
+        ids.push_back(can_id);
+    }
+    std::sort(ids.begin(), ids.end());
+
+    out << "TX latency per CAN ID, from queuing to the driver's TX timestamp and to the confirmation:" << std::endl;
+
+    for (canid_t can_id : ids)
+    {
+        const Entry& entry = m_entries.at(can_id);
+
+        out << "  ID=0x" << std::hex << std::uppercase << (can_id & CAN_EFF_MASK) << std::dec
+            << " sent=" << entry.sent_count << std::endl;
+        print_histogram(out, "driver:   ", entry.driver);
+        print_histogram(out, "confirmed:", entry.confirmed);
+        if (entry.hw_period.count() > 0)
+        {
+            print_histogram(out, "hw period:", entry.hw_period);
+        }
+    }
+
+    uint64_t unconfirmed = m_confirmed.missed_count + (m_sent_count - m_confirmed.cursor);
+    out << "Frames without confirmation: " << unconfirmed << ", without TX timestamp: "
+        << m_driver.missed_count + (m_sent_count - m_driver.cursor) << std::endl;
+}
+
+void TxLatency::print_histogram(std::ostream& out, const char* name, const LatencyHistogram& histogram)
+{
+    out << "    " << name << " frames=" << histogram.count();
+    histogram.print_percentiles(out);
+    out << std::endl;
+}
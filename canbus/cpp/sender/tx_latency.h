@@ -0,0 +1,113 @@
+// Copyright (c) 2025 by T3 Foundation. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//     https://docs.t3gemstone.org/en/license
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TX_LATENCY_H
+#define TX_LATENCY_H
+
+#include "hw_timestamp.h"
+#include "latency_histogram.h"
+#include <linux/can.h>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <ostream>
+#include <string>
+#include <sys/socket.h>
+#include <unordered_map>
+#include <vector>
+
+// Measures per CAN ID how long frames take from being queued on the socket until the driver timestamps them
+// (TX timestamps on the socket's error queue, where the driver supports them) and until the controller confirms
+// them (the frame echoed back through CAN_RAW_RECV_OWN_MSGS, which drivers do on TX completion). Both are
+// matched to the sent frames by order and CAN ID, as the kernel reports them in the order the frames went out.
+// Latencies use the kernel's CLOCK_REALTIME software timestamps. Hardware timestamps run on the controller's
+// clock, so they only give the period between consecutive TX timestamps of an ID.
+class TxLatency
+{
+  public:
+    static constexpr size_t PENDING_CAPACITY = 1 << 16; // Frames in flight tracked, a power of two
+    static constexpr size_t RECEIVE_BATCH = 64;
+
+    TxLatency();
+
+    // Enables own message reception and TX timestamps on a bound CAN_RAW socket. With use_hw_timestamps the
+    // interface is also switched to hardware timestamping, see restore().
+    int setup(int socket, const std::string& interface_name, bool use_hw_timestamps);
+
+    // Restores the interface's hardware timestamping setting changed by setup(), call before closing the socket
+    void restore(int socket);
+
+    // Records a frame accepted by the kernel, in send order. queued_ns is CLOCK_REALTIME before the send call.
+    void add_sent(canid_t can_id, uint64_t queued_ns);
+
+    // Reads the confirmations and TX timestamps available without blocking
+    void collect(int socket);
+
+    // Waits up to timeout_ms for the confirmations of the frames still in flight
+    void finish(int socket, int timeout_ms);
+
+    void report(std::ostream& out) const;
+
+  private:
+    struct Entry
+    {
+        uint64_t sent_count {0};
+        LatencyHistogram driver {};
+        LatencyHistogram confirmed {};
+        uint64_t last_hw_ns {0}; // Hardware TX timestamp of the previous frame
+        LatencyHistogram hw_period {};
+    };
+
+    struct Pending
+    {
+        canid_t can_id;
+        uint64_t queued_ns;
+    };
+
+    // One cursor per report stream into the sent frames, frames it skipped were never reported
+    struct Stream
+    {
+        uint64_t cursor {0};
+        uint64_t missed_count {0};
+    };
+
+    // Room for struct scm_timestamping (three timespecs) and the sock_extended_err of the error queue
+    struct ControlBuffer
+    {
+        alignas(struct cmsghdr) char data[CMSG_SPACE(3 * sizeof(struct timespec)) + CMSG_SPACE(64)];
+    };
+
+    std::unordered_map<canid_t, Entry> m_entries {};
+    std::vector<Pending> m_pending {};
+    uint64_t m_sent_count {0};
+    Stream m_driver {};
+    Stream m_confirmed {};
+    bool m_has_hw_timestamps {false};
+    HwTimestampConfig m_saved_hw_timestamps {}; // Restored by restore() when m_has_hw_timestamps
+
+    // Preallocated receive batch for recvmmsg()
+    std::vector<canfd_frame> m_frames {};
+    std::vector<ControlBuffer> m_controls {};
+    std::vector<struct iovec> m_iovecs {};
+    std::vector<struct mmsghdr> m_messages {};
+
+    bool receive(int socket, int flags);
+    void match(Stream& stream, canid_t can_id, const struct msghdr& message, bool is_driver);
+    static void print_histogram(std::ostream& out, const char* name, const LatencyHistogram& histogram);
+};
+
+#endif // TX_LATENCY_H